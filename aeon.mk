@@ -62,7 +62,7 @@ AS       := /usr/bin/as
 ## User defined environment variables
 ##
 CodeLiteDir:=/Applications/codelite.app/Contents/SharedSupport/
-Objects0=$(IntermediateDirectory)/src_ecs_types.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_ecs_node.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_ecs_engine.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_ecs_main.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_dsl_dsl.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_aeon_aeon.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_aeon_Pool.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_aeon_test.cpp$(ObjectSuffix) 
+Objects0=$(IntermediateDirectory)/src_ecs_types.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_ecs_node.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_ecs_engine.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_ecs_main.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_dsl_dsl.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_aeon_aeon.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_aeon_Pool.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_aeon_test.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_ecs_archetype.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_ecs_sparse.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_ecs_view.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_ecs_bench.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_ecs_sched.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_ecs_cmds.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_ecs_profile.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_ecs_snapshot.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_ecs_spatial.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_ecs_shard.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_ecs_prefab.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_ecs_hierarchy.cpp$(ObjectSuffix) 
 
 
 
@@ -141,6 +141,78 @@ $(IntermediateDirectory)/src_aeon_test.cpp$(ObjectSuffix): src/aeon/test.cpp
 $(IntermediateDirectory)/src_aeon_test.cpp$(PreprocessSuffix): src/aeon/test.cpp
 	$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_aeon_test.cpp$(PreprocessSuffix) src/aeon/test.cpp
 
+$(IntermediateDirectory)/src_ecs_archetype.cpp$(ObjectSuffix): src/ecs/archetype.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_ecs_archetype.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_ecs_archetype.cpp$(DependSuffix) -MM src/ecs/archetype.cpp
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/Users/kenl/wdrive/mygit/lang/aeon/src/ecs/archetype.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_ecs_archetype.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_ecs_archetype.cpp$(PreprocessSuffix): src/ecs/archetype.cpp
+	$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_ecs_archetype.cpp$(PreprocessSuffix) src/ecs/archetype.cpp
+
+$(IntermediateDirectory)/src_ecs_sparse.cpp$(ObjectSuffix): src/ecs/sparse.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_ecs_sparse.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_ecs_sparse.cpp$(DependSuffix) -MM src/ecs/sparse.cpp
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/Users/kenl/wdrive/mygit/lang/aeon/src/ecs/sparse.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_ecs_sparse.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_ecs_sparse.cpp$(PreprocessSuffix): src/ecs/sparse.cpp
+	$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_ecs_sparse.cpp$(PreprocessSuffix) src/ecs/sparse.cpp
+
+$(IntermediateDirectory)/src_ecs_view.cpp$(ObjectSuffix): src/ecs/view.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_ecs_view.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_ecs_view.cpp$(DependSuffix) -MM src/ecs/view.cpp
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/Users/kenl/wdrive/mygit/lang/aeon/src/ecs/view.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_ecs_view.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_ecs_view.cpp$(PreprocessSuffix): src/ecs/view.cpp
+	$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_ecs_view.cpp$(PreprocessSuffix) src/ecs/view.cpp
+
+$(IntermediateDirectory)/src_ecs_bench.cpp$(ObjectSuffix): src/ecs/bench.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_ecs_bench.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_ecs_bench.cpp$(DependSuffix) -MM src/ecs/bench.cpp
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/Users/kenl/wdrive/mygit/lang/aeon/src/ecs/bench.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_ecs_bench.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_ecs_bench.cpp$(PreprocessSuffix): src/ecs/bench.cpp
+	$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_ecs_bench.cpp$(PreprocessSuffix) src/ecs/bench.cpp
+
+$(IntermediateDirectory)/src_ecs_sched.cpp$(ObjectSuffix): src/ecs/sched.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_ecs_sched.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_ecs_sched.cpp$(DependSuffix) -MM src/ecs/sched.cpp
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/Users/kenl/wdrive/mygit/lang/aeon/src/ecs/sched.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_ecs_sched.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_ecs_sched.cpp$(PreprocessSuffix): src/ecs/sched.cpp
+	$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_ecs_sched.cpp$(PreprocessSuffix) src/ecs/sched.cpp
+
+$(IntermediateDirectory)/src_ecs_cmds.cpp$(ObjectSuffix): src/ecs/cmds.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_ecs_cmds.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_ecs_cmds.cpp$(DependSuffix) -MM src/ecs/cmds.cpp
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/Users/kenl/wdrive/mygit/lang/aeon/src/ecs/cmds.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_ecs_cmds.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_ecs_cmds.cpp$(PreprocessSuffix): src/ecs/cmds.cpp
+	$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_ecs_cmds.cpp$(PreprocessSuffix) src/ecs/cmds.cpp
+
+$(IntermediateDirectory)/src_ecs_profile.cpp$(ObjectSuffix): src/ecs/profile.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_ecs_profile.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_ecs_profile.cpp$(DependSuffix) -MM src/ecs/profile.cpp
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/Users/kenl/wdrive/mygit/lang/aeon/src/ecs/profile.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_ecs_profile.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_ecs_profile.cpp$(PreprocessSuffix): src/ecs/profile.cpp
+	$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_ecs_profile.cpp$(PreprocessSuffix) src/ecs/profile.cpp
+
+$(IntermediateDirectory)/src_ecs_snapshot.cpp$(ObjectSuffix): src/ecs/snapshot.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_ecs_snapshot.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_ecs_snapshot.cpp$(DependSuffix) -MM src/ecs/snapshot.cpp
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/Users/kenl/wdrive/mygit/lang/aeon/src/ecs/snapshot.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_ecs_snapshot.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_ecs_snapshot.cpp$(PreprocessSuffix): src/ecs/snapshot.cpp
+	$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_ecs_snapshot.cpp$(PreprocessSuffix) src/ecs/snapshot.cpp
+
+$(IntermediateDirectory)/src_ecs_spatial.cpp$(ObjectSuffix): src/ecs/spatial.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_ecs_spatial.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_ecs_spatial.cpp$(DependSuffix) -MM src/ecs/spatial.cpp
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/Users/kenl/wdrive/mygit/lang/aeon/src/ecs/spatial.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_ecs_spatial.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_ecs_spatial.cpp$(PreprocessSuffix): src/ecs/spatial.cpp
+	$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_ecs_spatial.cpp$(PreprocessSuffix) src/ecs/spatial.cpp
+
+$(IntermediateDirectory)/src_ecs_shard.cpp$(ObjectSuffix): src/ecs/shard.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_ecs_shard.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_ecs_shard.cpp$(DependSuffix) -MM src/ecs/shard.cpp
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/Users/kenl/wdrive/mygit/lang/aeon/src/ecs/shard.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_ecs_shard.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_ecs_shard.cpp$(PreprocessSuffix): src/ecs/shard.cpp
+	$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_ecs_shard.cpp$(PreprocessSuffix) src/ecs/shard.cpp
+
+$(IntermediateDirectory)/src_ecs_prefab.cpp$(ObjectSuffix): src/ecs/prefab.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_ecs_prefab.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_ecs_prefab.cpp$(DependSuffix) -MM src/ecs/prefab.cpp
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/Users/kenl/wdrive/mygit/lang/aeon/src/ecs/prefab.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_ecs_prefab.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_ecs_prefab.cpp$(PreprocessSuffix): src/ecs/prefab.cpp
+	$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_ecs_prefab.cpp$(PreprocessSuffix) src/ecs/prefab.cpp
+
+$(IntermediateDirectory)/src_ecs_hierarchy.cpp$(ObjectSuffix): src/ecs/hierarchy.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_ecs_hierarchy.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_ecs_hierarchy.cpp$(DependSuffix) -MM src/ecs/hierarchy.cpp
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/Users/kenl/wdrive/mygit/lang/aeon/src/ecs/hierarchy.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_ecs_hierarchy.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_ecs_hierarchy.cpp$(PreprocessSuffix): src/ecs/hierarchy.cpp
+	$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_ecs_hierarchy.cpp$(PreprocessSuffix) src/ecs/hierarchy.cpp
+
 
 -include $(IntermediateDirectory)/*$(DependSuffix)
 ##
@@ -13,6 +13,9 @@
  * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
 
 #include <functional>
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
 #include <map>
 #include "Pool.h"
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
@@ -91,6 +94,58 @@ void MemPool::drop(void* obj) {
   --next;
 }
 
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+FreeList::FreeList(size_t size, size_t batch) {
+  // each free block holds the link to the next
+  this->size= std::max(size, sizeof(void*));
+  this->batch= batch;
+  this->head= nullptr;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+FreeList::~FreeList() {
+  for (auto c : chunks) { ::free(c); }
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void FreeList::grow() {
+  auto z= (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+  auto c= (char*) ::malloc(z * batch);
+  chunks.push_back(c);
+  for (size_t i= 0; i < batch; ++i) {
+    auto b= c + i * z;
+    *(void**)b = head;
+    head= b;
+  }
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+int FreeList::take(void** out, int n) {
+  std::lock_guard<std::mutex> g(lock);
+  auto i= 0;
+  for (; i < n; ++i) {
+    if (head == nullptr) { grow(); }
+    out[i]= head;
+    head= *(void**)head;
+  }
+  return i;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void FreeList::drop(void** blocks, int n) {
+  std::lock_guard<std::mutex> g(lock);
+  for (auto i= 0; i < n; ++i) {
+    *(void**)blocks[i] = head;
+    head= blocks[i];
+  }
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void* FreeList::take() {
+  void* p;
+  take(&p, 1);
+  return p;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void FreeList::drop(void* p) {
+  drop(&p, 1);
+}
+
 
 
 
@@ -1,3 +1,4 @@
+#pragma once
 /* Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
  * You may obtain a copy of the License at
@@ -13,6 +14,8 @@
  * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
 
 #include <functional>
+#include <mutex>
+#include <vector>
 #include <map>
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
@@ -38,6 +41,30 @@ private:
   std::function<void* ()> ctor;
 };
 
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// Raw fixed-size blocks carved out of big chunks, freed blocks are
+// chained together for reuse.  Chunks are only released when the
+// list goes away.  Thread safe, move blocks in batches to keep the
+// lock cold.
+class FreeList {
+public:
+  FreeList(size_t size, size_t batch= 256);
+  ~FreeList();
+  // take up to n blocks, returns how many were taken
+  int take(void** out, int n);
+  void drop(void** blocks, int n);
+  void* take();
+  void drop(void*);
+  size_t blockSize() { return size; }
+private:
+  void grow();
+  size_t size;
+  size_t batch;
+  void* head;
+  std::vector<void*> chunks;
+  std::mutex lock;
+};
+
 
 
 
@@ -0,0 +1,222 @@
+/* Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
+
+#include "archetype.h"
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+namespace czlab::ecs {
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+Archetype::Archetype(const std::vector<Cid>& sig) {
+  _sig=sig;
+  _cols.resize(sig.size());
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+int Archetype::slot(Cid cid) const {
+  auto i= std::lower_bound(_sig.begin(), _sig.end(), cid);
+  return (i != _sig.end() && *i == cid) ? (int)(i - _sig.begin()) : -1;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+ComVec* Archetype::column(Cid cid) const {
+  auto n= slot(cid);
+  return n < 0 ? NULL : const_cast<ComVec*>(&_cols[n]);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+bool Archetype::covers(const std::vector<Cid>& q) const {
+  return std::includes(_sig.begin(), _sig.end(), q.begin(), q.end());
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+EntityId Archetype::erase(size_t row) {
+  auto last= _eids.size()-1;
+  EntityId moved=0;
+  if (row != last) {
+    moved= _eids[last];
+    _eids[row]= moved;
+    for (auto& c : _cols) { c[row]= c[last]; }
+  }
+  _eids.pop_back();
+  for (auto& c : _cols) { c.pop_back(); }
+  return moved;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+ArchetypeRegistry::ArchetypeRegistry() {
+  _root= reify(std::vector<Cid>());
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+ArchetypeRegistry::~ArchetypeRegistry() {
+  for (auto a : _all) { delete a; }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+Archetype* ArchetypeRegistry::reify(const std::vector<Cid>& sig) {
+  if (auto i= _types.find(sig); i != _types.end()) {
+    return i->second;
+  }
+  auto a= new Archetype(sig);
+  _types.insert(s__pair(std::vector<Cid>,Archetype*,sig,a));
+  s__conj(_all,a);
+  return a;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void ArchetypeRegistry::move(EntityId eid, Loc& loc, Archetype* to) {
+  auto from= loc.first;
+  auto row= loc.second;
+  // carry over the components both tables share
+  for (size_t i=0; i < to->_sig.size(); ++i) {
+    if (auto n= from->slot(to->_sig[i]); n >= 0) {
+      s__conj(to->_cols[i], from->_cols[n][row]);
+    }
+  }
+  s__conj(to->_eids, eid);
+  if (auto m= from->erase(row); m != 0) {
+    _where[m].second= row;
+  }
+  loc.first=to;
+  loc.second=to->size()-1;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void ArchetypeRegistry::put(Cid cid, EntityId eid, EComponent c) {
+  auto it= _where.find(eid);
+  if (it == _where.end()) {
+    s__conj(_root->_eids, eid);
+    it= _where.insert(s__pair(EntityId,Loc,eid,
+                              Loc(_root, _root->size()-1))).first;
+  }
+  auto& loc= it->second;
+  auto from= loc.first;
+  // already bound, keep the old one like the map backend
+  if (from->slot(cid) >= 0) { return; }
+
+  Archetype* to;
+  if (auto e= from->_plus.find(cid); e != from->_plus.end()) {
+    to= e->second;
+  } else {
+    auto sig= from->_sig;
+    sig.insert(std::lower_bound(sig.begin(), sig.end(), cid), cid);
+    to= reify(sig);
+    from->_plus[cid]= to;
+    to->_minus[cid]= from;
+  }
+  // the new column gets its value first, then the shared ones move over
+  s__conj(to->_cols[to->slot(cid)], c);
+  move(eid, loc, to);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void ArchetypeRegistry::remove(Cid cid, EntityId eid) {
+  auto it= _where.find(eid);
+  if (it == _where.end()) { return; }
+  auto& loc= it->second;
+  auto from= loc.first;
+  if (from->slot(cid) < 0) { return; }
+
+  Archetype* to;
+  if (auto e= from->_minus.find(cid); e != from->_minus.end()) {
+    to= e->second;
+  } else {
+    auto sig= from->_sig;
+    sig.erase(std::lower_bound(sig.begin(), sig.end(), cid));
+    to= reify(sig);
+    from->_minus[cid]= to;
+    to->_plus[cid]= from;
+  }
+  move(eid, loc, to);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+Component* ArchetypeRegistry::lookup(Cid cid, EntityId eid) const {
+  if (auto it= _where.find(eid); it != _where.end()) {
+    auto a= it->second.first;
+    if (auto n= a->slot(cid); n >= 0) {
+      return a->_cols[n][it->second.second].ptr();
+    }
+  }
+  return NULL;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void ArchetypeRegistry::collect(const std::vector<Cid>& cs, std::vector<EntityId>& out) const {
+  auto q= cs;
+  std::sort(q.begin(), q.end());
+  if (q.empty()) { return; }
+  for (auto a : _all) {
+    if (a->size() > 0 && a->covers(q)) {
+      s__ccat(out, a->_eids);
+    }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void ArchetypeRegistry::purge(EntityId eid) {
+  if (auto it= _where.find(eid); it != _where.end()) {
+    auto a= it->second.first;
+    auto row= it->second.second;
+    _where.erase(it);
+    if (auto m= a->erase(row); m != 0) {
+      _where[m].second= row;
+    }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void ArchetypeRegistry::sweep(const std::vector<uint8_t>& dead) {
+  for (auto a : _all) {
+    // from the bottom up, so the row swapped in from the
+    // end has been looked at already
+    for (auto r= a->size(); r-- > 0;) {
+      auto eid= a->_eids[r];
+      auto k= entIndex(eid);
+      if (k >= dead.size() || !dead[k]) { continue; }
+      _where.erase(eid);
+      if (auto m= a->erase(r); m != 0) {
+        _where[m].second= r;
+      }
+    }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void ArchetypeRegistry::gather(Cid cid, std::vector<EntityId>& eids, std::vector<Component*>& cs) const {
+  for (auto a : _all) {
+    if (auto col= a->column(cid); X_NIL(col)) {
+      s__ccat(eids, a->_eids);
+      for (auto& c : *col) { s__conj(cs, c.ptr()); }
+    }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void ArchetypeRegistry::clear() {
+  // keep the tables and edges, they will most likely be needed again
+  for (auto a : _all) {
+    a->_eids.clear();
+    for (auto& c : a->_cols) { c.clear(); }
+  }
+  _where.clear();
+}
+
+
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+//EOF
+
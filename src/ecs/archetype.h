@@ -0,0 +1,133 @@
+#pragma once
+/* Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
+
+//////////////////////////////////////////////////////////////////////////////
+
+#include <unordered_map>
+#include "types.h"
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+namespace czlab::ecs {
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// All entities sharing the same set of component types.
+// Each component type is a column, each entity is a row.
+// Component objects are shared and bound by pointer, so a
+// column holds the pointers, by value types live in the
+// packed columns of pod.h instead.
+struct MSVC_DLL Archetype {
+
+  const std::vector<EntityId>& ents() const { return _eids; }
+  const std::vector<Cid>& sig() const { return _sig; }
+  size_t size() const { return _eids.size(); }
+
+  // return the column for this type, or NULL
+  ComVec* column(Cid) const;
+
+  // true if all of these (sorted) types are in this archetype
+  bool covers(const std::vector<Cid>&) const;
+
+  Archetype(const std::vector<Cid>& sig);
+  ~Archetype() {}
+
+  friend struct ArchetypeRegistry;
+  private:
+
+  // remove a row by swapping in the last one,
+  // return the entity that got moved, or 0
+  EntityId erase(size_t row);
+  int slot(Cid) const;
+
+  std::map<Cid,Archetype*> _plus;
+  std::map<Cid,Archetype*> _minus;
+  std::vector<EntityId> _eids;
+  std::vector<ComVec> _cols;
+  std::vector<Cid> _sig;
+
+  Archetype(const Archetype&) = delete;
+  Archetype& operator=(const Archetype&) = delete;
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// Registry backend which packs entities into archetype tables,
+// so iterating a set of components walks linear arrays.
+struct MSVC_DLL ArchetypeRegistry : public Registry {
+
+  virtual void put(Cid, EntityId, EComponent);
+  virtual void remove(Cid, EntityId);
+  virtual Component* lookup(Cid, EntityId) const;
+  virtual void collect(const std::vector<Cid>&, std::vector<EntityId>&) const;
+  virtual void purge(EntityId);
+  virtual void sweep(const std::vector<uint8_t>&);
+  virtual void gather(Cid, std::vector<EntityId>&, std::vector<Component*>&) const;
+  virtual void clear();
+
+  // call f(eid, T*...) for every entity with all of T...,
+  // one archetype at a time
+  template<typename... T, typename F>
+  void each(F f) const;
+
+  const std::vector<Archetype*>& archetypes() const { return _all; }
+
+  virtual ~ArchetypeRegistry();
+  ArchetypeRegistry();
+
+  private:
+
+  typedef std::pair<Archetype*,size_t> Loc;
+
+  template<typename... T, typename F, size_t... N>
+  static void eachRow(Archetype*, F&, std::index_sequence<N...>);
+
+  Archetype* reify(const std::vector<Cid>&);
+  void move(EntityId, Loc&, Archetype*);
+
+  std::map<std::vector<Cid>,Archetype*> _types;
+  std::unordered_map<EntityId,Loc> _where;
+  std::vector<Archetype*> _all;
+  Archetype* _root;
+
+  ArchetypeRegistry(const ArchetypeRegistry&) = delete;
+  ArchetypeRegistry& operator=(const ArchetypeRegistry&) = delete;
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename... T, typename F, size_t... N>
+void ArchetypeRegistry::eachRow(Archetype* a, F& f, std::index_sequence<N...>) {
+  std::array<ComVec*, sizeof...(T)> cols { a->column(EntityFeature<T>::id())... };
+  auto& eids= a->_eids;
+  for (size_t r=0, z=eids.size(); r < z; ++r) {
+    f(eids[r], s__cast(T, (*cols[N])[r].ptr())...);
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename... T, typename F>
+void ArchetypeRegistry::each(F f) const {
+  std::vector<Cid> q { EntityFeature<T>::id()... };
+  std::sort(q.begin(), q.end());
+  for (auto a : _all) {
+    if (a->size() > 0 && a->covers(q)) {
+      eachRow<T...>(a, f, std::index_sequence_for<T...>{});
+    }
+  }
+}
+
+
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+//EOF
+
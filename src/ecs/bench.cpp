@@ -0,0 +1,619 @@
+/* Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
+
+#include "archetype.h"
+#include "bench.h"
+#include "hierarchy.h"
+#include "pipeline.h"
+#include "prefab.h"
+#include "snapshot.h"
+#include "spatial.h"
+#include "sparse.h"
+#include "view.h"
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+namespace czlab::ecs {
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+namespace {
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+struct BLocation : public Component {
+  float x=0, y=0;
+};
+
+struct BHealth : public Component {
+  int hp=100;
+};
+
+struct BBullet : public Component, public Pooled<BBullet> {
+  float x=0, y=0;
+};
+
+struct BMotion : public Component {
+  struct { float x, y, vx, vy; } pod;
+};
+
+// same state, kept by value
+struct BVelocity {
+  float x, y, vx, vy;
+};
+
+struct BMotion2 {
+  float ax, ay;
+};
+
+struct BXform {
+  float x, y, wx, wy;
+};
+
+struct BWorld : public Engine {
+  BWorld(Registry* r) : Engine(r) {}
+  virtual ~BWorld() {}
+  virtual void initEnts() {}
+  virtual void initSystems() {}
+};
+
+// keeps the optimizer from dropping a result
+template<typename T>
+void keep(const T& v) {
+  static volatile size_t _sink;
+  _sink= _sink + (size_t)v;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void fill(Engine* g, llong count) {
+  for (llong i=0; i < count; ++i) {
+    auto e= g->reifyEnt();
+    g->rego()->bind<BLocation>(new BLocation(), e);
+    // half the world can be hurt
+    if (i % 2 == 0) {
+      g->rego()->bind<BHealth>(new BHealth(), e);
+    }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// make and destroy a world of entities with one component
+template<typename R>
+void spawnPurge(BenchState& st) {
+  BWorld g(new R());
+  auto n= st.arg();
+  while (st.next()) {
+    for (llong i=0; i < n; ++i) {
+      g.rego()->bind<BLocation>(new BLocation(), g.spawn());
+    }
+    g.purgeEnts();
+  }
+  st.items(n);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// add a component to every entity then take it off again
+template<typename R>
+void bindUnbind(BenchState& st) {
+  BWorld g(new R());
+  std::vector<EntityId> all;
+  for (llong i=0; i < st.arg(); ++i) {
+    auto e= g.spawn();
+    g.rego()->bind<BLocation>(new BLocation(), e);
+    s__conj(all, e);
+  }
+  while (st.next()) {
+    for (auto e : all) { g.rego()->bind<BHealth>(new BHealth(), e); }
+    for (auto e : all) { g.rego()->unbind<BHealth>(e); }
+  }
+  st.items(2 * st.arg());
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename R>
+void getEntsOne(BenchState& st) {
+  BWorld g(new R());
+  fill(&g, st.arg());
+  while (st.next()) { keep(g.getEnts<BLocation>().size()); }
+  st.items(st.arg());
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename R>
+void getEntsMulti(BenchState& st) {
+  BWorld g(new R());
+  fill(&g, st.arg());
+  std::vector<Cid> q { EntityFeature<BLocation>::id(),
+                       EntityFeature<BHealth>::id() };
+  while (st.next()) { keep(g.getEnts(q).size()); }
+  st.items(st.arg());
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// walk a cached Location+Health view
+template<typename R>
+void viewEach(BenchState& st) {
+  BWorld g(new R());
+  fill(&g, st.arg());
+  auto v= g.view<BLocation,BHealth>();
+  while (st.next()) {
+    v->forEach<BLocation,BHealth>([](EntityId, BLocation& l, BHealth& h) {
+      l.x += 1;
+      h.hp -= 1;
+    });
+  }
+  st.items(v->size());
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+struct BMove : public System {
+  BMove(Engine* g) : System(g) {
+    writes<BLocation>();
+    _v= g->view<BLocation>();
+  }
+  virtual bool update(float dt) {
+    _v->forEach<BLocation>([dt](EntityId, BLocation& l) { l.x += dt; });
+    return true;
+  }
+  virtual void preamble() {}
+  virtual int priority() const { return 2; }
+  View* _v;
+};
+
+struct BHurt : public System {
+  BHurt(Engine* g) : System(g) {
+    reads<BLocation>();
+    writes<BHealth>();
+    _v= g->view<BLocation,BHealth>();
+  }
+  virtual bool update(float) {
+    _v->forEach<BLocation,BHealth>([](EntityId, BLocation& l, BHealth& h) {
+      if (l.x > 0) { h.hp -= 1; }
+    });
+    return true;
+  }
+  virtual void preamble() {}
+  virtual int priority() const { return 1; }
+  View* _v;
+};
+
+// one full engine tick with two systems
+template<typename R>
+void updateTick(BenchState& st) {
+  BWorld g(new R());
+  fill(&g, st.arg());
+  g.addSystem(new BMove(&g));
+  g.addSystem(new BHurt(&g));
+  while (st.next()) { g.update(0.016f); }
+  st.items(st.arg());
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// a frame of spawning and killing a wave of bullets, heap
+// allocated vs pooled entities and components
+template<typename C, bool Take>
+void churn(BenchState& st) {
+  BWorld g(new Registry());
+  std::vector<EntityId> live;
+  while (st.next()) {
+    for (auto& eid : live) { g.purgeEnt(eid); }
+    live.clear();
+    for (llong i=0; i < st.arg(); ++i) {
+      auto e= g.reifyEnt(Take);
+      g.rego()->bind<C>(new C(), e);
+      s__conj(live, e->id());
+    }
+    g.update(0);
+  }
+  st.items(st.arg());
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// a world with one pod component each, plus a write through a
+// stale handle which must not end up in the snapshot, restore()
+// fails if it does
+template<typename T>
+void build(Engine& g, llong count) {
+  snapshotable<T>();
+  for (llong i=0; i < count; ++i) {
+    if constexpr (isPod<T>) {
+      g.rego()->add<T>(g.spawn())->x= (float) i;
+    } else {
+      auto c= new T();
+      c->pod.x= (float) i;
+      g.rego()->bind<T>(c, g.spawn());
+    }
+  }
+  auto dead= g.spawn();
+  g.purgeEnt(dead);
+  if constexpr (isPod<T>) {
+    g.rego()->add<T>(dead);
+  } else {
+    g.rego()->bind<T>(new T(), dead);
+  }
+}
+
+template<typename T, typename R>
+void snapshot(BenchState& st) {
+  BWorld g(new R());
+  build<T>(g, st.arg());
+  std::vector<char> blob;
+  while (st.next()) { g.snapshot(blob); }
+  st.items(st.arg());
+  st.label(N_STR(blob.size()) + " bytes");
+}
+
+template<typename T, typename R>
+void restore(BenchState& st) {
+  BWorld g(new R());
+  build<T>(g, st.arg());
+  std::vector<char> blob;
+  g.snapshot(blob);
+  auto ok= true;
+  while (st.next()) { ok= g.restore(blob) && ok; }
+  st.items(st.arg());
+  if (!ok) { st.label("FAILED"); }
+}
+
+// warm start, map a snapshot file and restore from it, by value
+// columns stay in the mapping
+template<typename T, typename R>
+void restoreMapped(BenchState& st) {
+  BWorld g(new R());
+  build<T>(g, st.arg());
+  auto file= "/tmp/ecs-bench-" + N_STR(st.arg()) + ".snap";
+  auto ok= g.snapshot(file);
+  while (st.next()) {
+    auto m= new MappedSnapshot();
+    m->open(file);
+    ok= g.restore(m) && ok;
+  }
+  ::remove(file.c_str());
+  st.items(st.arg());
+  if (!ok) { st.label("FAILED"); }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// find what moved when 1% of the world moves a frame, by
+// diffing everything or by asking changed()
+template<bool Rescan>
+void changes(BenchState& st) {
+  BWorld g(new SparseRegistry());
+  auto count= st.arg();
+  std::vector<EntityId> all, out;
+  for (llong i=0; i < count; ++i) {
+    auto e= g.spawn();
+    g.rego()->add<BVelocity>(e);
+    s__conj(all, e);
+  }
+  std::vector<BVelocity> seen;
+  for (auto eid : all) { s__conj(seen, g.rego()->get<BVelocity>(eid)); }
+  auto since= g.changed<BVelocity>(0, out);
+  size_t k=0;
+  while (st.next()) {
+    st.pause();
+    for (llong i=0; i < count/100; ++i) {
+      g.rego()->edit<BVelocity>(all[(k++ * 7919) % count]).x += 1;
+    }
+    st.resume();
+    if constexpr (Rescan) {
+      for (llong i=0; i < count; ++i) {
+        auto& v= g.rego()->get<BVelocity>(all[i]);
+        if (::memcmp(&v, &seen[i], sizeof(v)) != 0) { seen[i]= v; }
+      }
+    } else {
+      out.clear();
+      since= g.changed<BVelocity>(since, out);
+      keep(out.size());
+    }
+  }
+  st.items(count/100);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// who is near whom, every entity against every other one vs
+// a range query on the grid per entity
+template<bool Brute>
+void nearby(BenchState& st) {
+  BWorld g(new SparseRegistry());
+  auto count= st.arg();
+  std::vector<EntityId> all, near;
+  auto side= (int) (40 * std::sqrt((float)count));
+  ::srand(7);
+  for (llong i=0; i < count; ++i) {
+    auto e= g.spawn();
+    g.rego()->add<BVelocity>(e, BVelocity{ (float)(::rand() % side),
+                                           (float)(::rand() % side), 0, 0 });
+    s__conj(all, e);
+  }
+  auto r= 20.0f;
+  Spatial<BVelocity> grid(&g, r);
+  size_t hits=0;
+  while (st.next()) {
+    for (auto a : all) {
+      auto& p= g.rego()->get<BVelocity>(a);
+      if constexpr (Brute) {
+        for (auto b : all) {
+          auto& q= g.rego()->get<BVelocity>(b);
+          auto dx= p.x-q.x, dy= p.y-q.y;
+          if (dx*dx + dy*dy <= r*r) { ++hits; }
+        }
+      } else {
+        near.clear();
+        grid.range(p.x, p.y, r, near);
+        hits += near.size();
+      }
+    }
+  }
+  st.items(count);
+  st.label(N_STR(hits / std::max<llong>(1, st.iterations())) + " hits");
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// the living, a marker on a tenth of the world, by diffing two
+// queries vs a without filter
+struct BDead {};
+
+template<bool Diff>
+void without(BenchState& st) {
+  BWorld g(new SparseRegistry());
+  std::vector<EntityId> out, dead;
+  for (llong i=0; i < st.arg(); ++i) {
+    auto e= g.spawn();
+    g.rego()->add<BVelocity>(e);
+    if (i % 10 == 0) { g.rego()->tag<BDead>(e); }
+  }
+  auto f= with<BVelocity>().without<BDead>();
+  while (st.next()) {
+    out.clear();
+    if constexpr (Diff) {
+      dead.clear();
+      g.query(std::vector<Cid>{ EntityFeature<BVelocity>::id() }, out);
+      g.query(std::vector<Cid>{ EntityFeature<BDead>::id() }, dead);
+      std::sort(dead.begin(), dead.end());
+      out.erase(std::remove_if(out.begin(), out.end(), [&dead](EntityId e) {
+        return std::binary_search(dead.begin(), dead.end(), e);
+      }), out.end());
+    } else {
+      g.query(f, out);
+    }
+    keep(out.size());
+  }
+  st.items(st.arg());
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// a wave of alike entities, one at a time vs from a prefab
+template<bool Batch>
+void wave(BenchState& st) {
+  BWorld g(new SparseRegistry());
+  Prefab p;
+  p.add<BVelocity>(BVelocity{ 1, 2, 0, 0 }).tag<BDead>();
+  std::vector<EntityId> ids;
+  while (st.next()) {
+    ids.clear();
+    if constexpr (Batch) {
+      g.spawnBatch(p, st.arg(), ids);
+    } else {
+      for (llong i=0; i < st.arg(); ++i) {
+        auto e= g.spawn();
+        g.rego()->add<BVelocity>(e, BVelocity{ 1, 2, 0, 0 });
+        g.rego()->tag<BDead>(e);
+        s__conj(ids, e);
+      }
+    }
+    st.pause();
+    g.purgeEnts();
+    st.resume();
+  }
+  st.items(st.arg());
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// end of a level, purge everything one by one vs clearWorld(),
+// or half of the world one by one vs by a filter
+template<bool Bulk, bool Cull>
+void teardown(BenchState& st) {
+  BWorld g(new SparseRegistry());
+  Prefab live, dead;
+  live.add<BVelocity>().add<BMotion2>();
+  dead.add<BVelocity>().add<BMotion2>().tag<BDead>();
+  std::vector<EntityId> ids;
+  while (st.next()) {
+    st.pause();
+    ids.clear();
+    g.spawnBatch(live, st.arg() - st.arg()/2, ids);
+    g.spawnBatch(dead, st.arg()/2, ids);
+    if (Cull) {
+      ids.clear();
+      g.query(with<BDead>(), ids);
+    }
+    st.resume();
+    if constexpr (Bulk) {
+      if (Cull) { g.purgeEnts(with<BDead>()); } else { g.clearWorld(); }
+    } else {
+      for (auto e : ids) { g.purgeEnt(e); }
+    }
+    st.pause();
+    g.clearWorld();
+    st.resume();
+  }
+  st.items(Cull ? st.arg()/2 : st.arg());
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+static void descend(BWorld& g, std::map<EntityId,std::vector<EntityId>>& kids,
+                    EntityId e, float px, float py) {
+  auto& t= g.rego()->get<BXform>(e);
+  t.wx= px + t.x;
+  t.wy= py + t.y;
+  if (auto i= kids.find(e); i != kids.end()) {
+    for (auto c : i->second) { descend(g, kids, c, t.wx, t.wy); }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// world transforms down a forest, recursing through a map of
+// children vs one pass over the depth sorted links
+template<bool Sorted>
+void propagate(BenchState& st) {
+  BWorld g(new SparseRegistry());
+  std::map<EntityId,std::vector<EntityId>> kids;
+  std::vector<EntityId> ids, roots;
+  for (llong i=0; i < st.arg(); ++i) {
+    auto e= g.spawn();
+    g.rego()->add<BXform>(e, BXform{ 1, 1, 0, 0 });
+    s__conj(ids, e);
+  }
+  // four children apiece, spread over the table
+  ::srand(7);
+  for (auto i= ids.size(); i-- > 1;) {
+    std::swap(ids[i], ids[::rand() % (i+1)]);
+  }
+  for (size_t i=0; i < ids.size(); ++i) {
+    if (i == 0 || i % 1000 == 0) {
+      s__conj(roots, ids[i]);
+      continue;
+    }
+    auto p= ids[(i-1)/4];
+    if constexpr (Sorted) { g.adopt(p, ids[i]); } else { s__conj(kids[p], ids[i]); }
+  }
+  auto xs= g.rego()->column<BXform>();
+  // the first call sorts
+  g.hierarchy();
+  while (st.next()) {
+    if constexpr (Sorted) {
+      auto h= g.hierarchy();
+      auto& es= h->ids();
+      auto& rs= h->data();
+      for (size_t i=0; i < es.size(); ++i) {
+        auto& t= *xs->get(es[i]);
+        if (rs[i].parent != 0) {
+          auto& p= *xs->get(rs[i].parent);
+          t.wx= p.wx + t.x;
+          t.wy= p.wy + t.y;
+        } else {
+          t.wx= t.x;
+          t.wy= t.y;
+        }
+      }
+    } else {
+      for (auto r : roots) { descend(g, kids, r, 0, 0); }
+    }
+  }
+  st.items(st.arg());
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// next to nothing per system, so a tick is all dispatch
+template<size_t K>
+struct BTiny final : public System {
+  BTiny(Engine* g) : System(g) {}
+  virtual bool update(float dt) { _t += dt; return true; }
+  virtual void preamble() {}
+  virtual int priority() const { return (int) K; }
+  float _t=0;
+};
+
+template<bool Piped, size_t... K>
+void tinies(BenchState& st, std::index_sequence<K...>) {
+  BWorld g(new SparseRegistry());
+  if constexpr (Piped) {
+    g.addSystem(new Pipeline<BTiny<K>...>(&g));
+  } else {
+    (g.addSystem(new BTiny<K>(&g)), ...);
+  }
+  while (st.next()) { g.update(0.016f); }
+  st.items(sizeof...(K));
+}
+
+// 256 systems added one by one vs as one pipeline
+template<bool Piped>
+void dispatch(BenchState& st) {
+  tinies<Piped>(st, std::make_index_sequence<256>());
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+#define ECS_SIZES 1000, 100000, 1000000
+
+ECS_BENCH("spawnPurge/map", spawnPurge<Registry>, ECS_SIZES);
+ECS_BENCH("spawnPurge/archetype", spawnPurge<ArchetypeRegistry>, ECS_SIZES);
+ECS_BENCH("spawnPurge/sparse", spawnPurge<SparseRegistry>, ECS_SIZES);
+
+ECS_BENCH("bindUnbind/map", bindUnbind<Registry>, ECS_SIZES);
+ECS_BENCH("bindUnbind/archetype", bindUnbind<ArchetypeRegistry>, ECS_SIZES);
+ECS_BENCH("bindUnbind/sparse", bindUnbind<SparseRegistry>, ECS_SIZES);
+
+ECS_BENCH("getEnts<T>/map", getEntsOne<Registry>, ECS_SIZES);
+ECS_BENCH("getEnts<T>/archetype", getEntsOne<ArchetypeRegistry>, ECS_SIZES);
+ECS_BENCH("getEnts<T>/sparse", getEntsOne<SparseRegistry>, ECS_SIZES);
+
+ECS_BENCH("getEnts(cids)/map", getEntsMulti<Registry>, ECS_SIZES);
+ECS_BENCH("getEnts(cids)/archetype", getEntsMulti<ArchetypeRegistry>, ECS_SIZES);
+ECS_BENCH("getEnts(cids)/sparse", getEntsMulti<SparseRegistry>, ECS_SIZES);
+
+ECS_BENCH("viewEach/map", viewEach<Registry>, ECS_SIZES);
+ECS_BENCH("viewEach/archetype", viewEach<ArchetypeRegistry>, ECS_SIZES);
+ECS_BENCH("viewEach/sparse", viewEach<SparseRegistry>, ECS_SIZES);
+
+ECS_BENCH("update/map", updateTick<Registry>, ECS_SIZES);
+ECS_BENCH("update/archetype", updateTick<ArchetypeRegistry>, ECS_SIZES);
+ECS_BENCH("update/sparse", updateTick<SparseRegistry>, ECS_SIZES);
+
+ECS_BENCH("churn/heap", (churn<BLocation,false>), 1000, 10000);
+ECS_BENCH("churn/pooled", (churn<BBullet,true>), 1000, 10000);
+
+ECS_BENCH("snapshot/map", (snapshot<BMotion,Registry>), ECS_SIZES);
+ECS_BENCH("snapshot/sparse", (snapshot<BMotion,SparseRegistry>), ECS_SIZES);
+ECS_BENCH("snapshot/by-value", (snapshot<BVelocity,SparseRegistry>), ECS_SIZES);
+ECS_BENCH("restore/map", (restore<BMotion,Registry>), ECS_SIZES);
+ECS_BENCH("restore/sparse", (restore<BMotion,SparseRegistry>), ECS_SIZES);
+ECS_BENCH("restore/by-value", (restore<BVelocity,SparseRegistry>), ECS_SIZES);
+ECS_BENCH("restoreMapped/by-value", (restoreMapped<BVelocity,SparseRegistry>), ECS_SIZES);
+
+ECS_BENCH("changes/rescan", changes<true>, 100000, 1000000);
+ECS_BENCH("changes/changed", changes<false>, 100000, 1000000);
+
+ECS_BENCH("nearby/brute", nearby<true>, 1000, 10000);
+ECS_BENCH("nearby/grid", nearby<false>, 1000, 10000, 100000);
+
+ECS_BENCH("without/diff", without<true>, ECS_SIZES);
+ECS_BENCH("without/filter", without<false>, ECS_SIZES);
+
+ECS_BENCH("wave/single", wave<false>, 1000, 10000, 100000);
+ECS_BENCH("wave/batch", wave<true>, 1000, 10000, 100000);
+
+ECS_BENCH("teardown/one-by-one", (teardown<false,false>), 10000, 100000, 1000000);
+ECS_BENCH("teardown/clearWorld", (teardown<true,false>), 10000, 100000, 1000000);
+ECS_BENCH("cull/one-by-one", (teardown<false,true>), 10000, 100000, 1000000);
+ECS_BENCH("cull/filter", (teardown<true,true>), 10000, 100000, 1000000);
+
+ECS_BENCH("propagate/recursive", propagate<false>, 10000, 100000, 1000000);
+ECS_BENCH("propagate/sorted", propagate<true>, 10000, 100000, 1000000);
+
+ECS_BENCH("dispatch/virtual", dispatch<false>);
+ECS_BENCH("dispatch/pipeline", dispatch<true>);
+
+
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+int bench(int ac, char** av) {
+  return runBenches(ac, av);
+}
+
+
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+//EOF
+
@@ -0,0 +1,169 @@
+#pragma once
+/* Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
+
+//////////////////////////////////////////////////////////////////////////////
+// A small benchmark harness in the spirit of google-benchmark,
+// no dependencies so it runs anywhere.  A case is a function
+// taking a BenchState, setup goes before the loop:
+//
+//   void spawnMany(BenchState& st) {
+//     auto n= st.arg();
+//     while (st.next()) { ...timed... }
+//     st.items(n);
+//   }
+//   ECS_BENCH("spawn", spawnMany, 1000, 100000);
+//
+// then `ecs bench [filter] [--json=file] [--min-time=secs]`.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include "types.h"
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+namespace czlab::ecs {
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+struct BenchState {
+
+  typedef std::chrono::steady_clock Clock;
+
+  // true while there are iterations left, the clock runs
+  // from the first call to the last
+  bool next() {
+    if (_left == _iters) { _t0= Clock::now(); }
+    if (_left-- > 0) { return true; }
+    _ns += std::chrono::duration<double,std::nano>(Clock::now() - _t0).count();
+    return false;
+  }
+
+  // keep per iteration setup out of the timing
+  void pause() {
+    _ns += std::chrono::duration<double,std::nano>(Clock::now() - _t0).count();
+  }
+  void resume() { _t0= Clock::now(); }
+
+  // the size this run is for
+  llong arg() const { return _arg; }
+
+  // items handled per iteration, for a rate
+  void items(llong n) { _items= n; }
+
+  // shown next to the numbers
+  void label(const stdstr& s) { _label= s; }
+
+  llong iterations() const { return _iters; }
+  double nanos() const { return _ns; }
+  llong itemCount() const { return _items; }
+  const stdstr& labelText() const { return _label; }
+
+  BenchState(llong arg, llong iters) {
+    _arg=arg; _iters=iters; _left=iters;
+  }
+
+  private:
+
+  Clock::time_point _t0;
+  stdstr _label;
+  llong _items=0;
+  llong _iters;
+  llong _left;
+  llong _arg;
+  double _ns=0;
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+struct BenchCase {
+  stdstr name;
+  void (*fn)(BenchState&);
+  std::vector<llong> args;
+};
+
+inline std::vector<BenchCase>& benchCases() {
+  static std::vector<BenchCase> _cases;
+  return _cases;
+}
+
+inline int enrollBench(const char* name,
+                       void (*fn)(BenchState&), std::vector<llong> args) {
+  if (args.empty()) { s__conj(args, 0); }
+  s__conj(benchCases(), (BenchCase{ name, fn, args }));
+  return (int) benchCases().size();
+}
+
+#define ECS_BENCH_CAT2(a,b) a##b
+#define ECS_BENCH_CAT(a,b) ECS_BENCH_CAT2(a,b)
+#define ECS_BENCH(name, fn, ...) \
+  static int ECS_BENCH_CAT(__ecs_bench_, __LINE__)= \
+    czlab::ecs::enrollBench(name, fn, { __VA_ARGS__ })
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// run the cases whose name has filter in it, each size again with
+// twice the iterations until it takes minTime seconds
+inline int runBenches(int ac, char** av) {
+  stdstr filter, json;
+  double minTime= 0.2;
+  for (auto i=2; i < ac; ++i) {
+    stdstr a= av[i];
+    if (a.rfind("--json=", 0) == 0) {
+      json= a.substr(7);
+    } else if (a.rfind("--min-time=", 0) == 0) {
+      minTime= ::atof(a.c_str() + 11);
+    } else {
+      filter= a;
+    }
+  }
+  auto out= j::json::array();
+  ::printf("%-36s %14s %12s %14s\n", "benchmark", "ns/iter", "iterations", "items/s");
+  for (auto& c : benchCases()) {
+    if (!filter.empty() && c.name.find(filter) == stdstr::npos) { continue; }
+    for (auto arg : c.args) {
+      auto name= c.name + (arg > 0 ? "/" + N_STR(arg) : "");
+      llong n=1;
+      for (;;) {
+        BenchState st(arg, n);
+        c.fn(st);
+        auto secs= st.nanos() / 1e9;
+        if (secs >= minTime || n >= (1LL << 30)) {
+          auto per= st.nanos() / n;
+          auto rate= st.itemCount() > 0 ? st.itemCount() * 1e9 / per : 0;
+          ::printf("%-36s %14.0f %12lld %14.4g %s\n",
+                   name.c_str(), per, (long long) n, rate, st.labelText().c_str());
+          ::fflush(stdout);
+          out.push_back({{"name", name}, {"iterations", n},
+                         {"ns_per_iter", per}, {"items_per_sec", rate},
+                         {"label", st.labelText()}});
+          break;
+        }
+        // aim a bit past minTime from what one run took
+        auto guess= secs > 0 ? (llong)(n * minTime * 1.4 / secs) : n*10;
+        n= std::max(n*2, std::min(guess, n*100));
+      }
+    }
+  }
+  if (!json.empty()) {
+    std::ofstream f(json);
+    f << out.dump(2);
+  }
+  return 0;
+}
+
+
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+//EOF
+
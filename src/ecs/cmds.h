@@ -0,0 +1,146 @@
+#pragma once
+/* Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
+
+//////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include "pod.h"
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+namespace czlab::ecs {
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+enum CmdOp{
+  C_BIND = 1,
+  C_UNBIND,
+  // by value components and tags, done by Cmd::fn
+  C_APPLY,
+  C_PURGE
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// Structural changes recorded by one thread, applied later by
+// Engine::flush().  Entities made here get a negative placeholder
+// id which is only meaningful to this buffer, resolve() gives the
+// real one once flushed.
+struct MSVC_DLL Commands {
+
+  EntityId reifyEnt();
+  void purgeEnt(EntityId);
+
+  // the entity a placeholder from the last flush of this buffer
+  // became, good until the next flush which makes entities.
+  // 0 if unknown, real ids are passed through
+  EntityId resolve(EntityId) const;
+
+  template<typename T>
+  void bind(T* c, EntityId e) {
+    push(C_BIND, EntityFeature<T>::id(), e, c);
+  }
+
+  template<typename T>
+  void unbind(EntityId e) {
+    push(C_UNBIND, EntityFeature<T>::id(), e, P_NIL);
+  }
+
+  // the same as Registry::add(), erase(), tag() and untag() once
+  // flushed, v is copied now
+  template<typename T>
+  void add(EntityId e, const T& v= T()) {
+    static_assert(!isTag<T>, "use tag() for empty types");
+    static_assert(isPod<T>, "use bind() for Component types");
+    auto at= _bytes.size();
+    _bytes.resize(at + sizeof(T));
+    ::memcpy(_bytes.data() + at, &v, sizeof(T));
+    apply(EntityFeature<T>::id(), e, &put<T>, at);
+  }
+
+  template<typename T>
+  void erase(EntityId e) {
+    apply(EntityFeature<T>::id(), e, &drop<T>, 0);
+  }
+
+  template<typename T>
+  void tag(EntityId e) {
+    static_assert(isTag<T>, "tags are empty structs");
+    apply(EntityFeature<T>::id(), e, &mark<T>, 0);
+  }
+
+  template<typename T>
+  void untag(EntityId e) {
+    static_assert(isTag<T>, "tags are empty structs");
+    apply(EntityFeature<T>::id(), e, &unmark<T>, 0);
+  }
+
+  bool isEmpty() const { return _cmds.empty() && _made == 0; }
+  size_t size() const { return _cmds.size() + _made; }
+
+  Commands() {}
+  ~Commands() {}
+
+  friend struct Engine;
+  private:
+
+  // a typed change with its bytes, if any
+  typedef void (*Fn)(Registry*, EntityId, const char*);
+
+  struct Cmd {
+    int op;
+    Cid cid;
+    EntityId eid;
+    size_t seq;
+    EComponent c;
+    Fn fn;
+    // where the value starts in _bytes
+    size_t at;
+  };
+
+  template<typename T>
+  static void put(Registry* r, EntityId e, const char* in) {
+    T v;
+    ::memcpy(&v, in, sizeof(T));
+    r->template add<T>(e, v);
+  }
+  template<typename T>
+  static void drop(Registry* r, EntityId e, const char*) { r->template erase<T>(e); }
+  template<typename T>
+  static void mark(Registry* r, EntityId e, const char*) { r->template tag<T>(e); }
+  template<typename T>
+  static void unmark(Registry* r, EntityId e, const char*) { r->template untag<T>(e); }
+
+  void push(int, Cid, EntityId, EComponent);
+  void apply(Cid, EntityId, Fn, size_t at);
+  void clear();
+
+  std::vector<Cmd> _cmds;
+  // the values of add()s, packed
+  std::vector<char> _bytes;
+  size_t _made=0;
+  // placeholders keep counting across flushes so an old one
+  // never resolves to a newer entity
+  size_t _base=0;
+  size_t _was=0;
+  std::vector<EntityId> _resolved;
+
+  Commands(const Commands&) = delete;
+  Commands& operator=(const Commands&) = delete;
+};
+
+
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+//EOF
+
@@ -12,7 +12,12 @@
  *
  * Copyright © 2013-2020, Kenneth Leung. All rights reserved. */
 
-#include "types.h"
+#include "cmds.h"
+#include "hierarchy.h"
+#include "profile.h"
+#include "sched.h"
+#include "snapshot.h"
+#include "view.h"
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 namespace czlab::ecs {
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
@@ -33,96 +38,535 @@ bool _compSystem(ESystem lhs, ESystem rhs) {
 }
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
-Engine::Engine() { _types= new Registry(); }
+// every engine gets a serial so threads can cache their command
+// buffer per engine without holding on to dangling pointers
+static std::atomic<llong> _lastSerial(0);
+
+struct CmdSlot {
+  llong serial;
+  Commands* cmds;
+};
+
+static thread_local std::vector<CmdSlot> _myCmds;
+
+// dead entity objects kept around for reifyEnt(take)
+static const size_t MAX_SPARE= 4096;
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
-Engine::~Engine() { DEL_PTR(_types); }
+Engine::Engine() : Engine(new Registry()) {}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+Engine::Engine(Registry* r) {
+  _sigWords= std::max((size_t)2, (size_t)EntityFeatureBase::lastId()/64 + 1);
+  _serial= ++_lastSerial;
+  _types= r;
+  _types->_engine= this;
+#if ECS_PROFILE
+  _prof= new Profiler();
+#endif
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+Engine::~Engine() {
+  for (auto i=_views.begin(),e=_views.end();i != e;++i) {
+    DEL_PTR(i->second);
+  }
+  for (auto c : _cmdbufs) { delete c; }
+  DEL_PTR(_sched);
+  DEL_PTR(_types);
+  DEL_PTR(_mapped);
+  DEL_PTR(_prof);
+  for (auto c : _changes) { delete c; }
+}
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 EntVec Engine::getEnts(const std::vector<Cid>& cs) const {
-  std::vector<MapEidC*> ccs;
+  std::vector<EntityId> ids;
+  EntVec out;
+  query(cs, ids);
+  findEnts(ids, out);
+  return out;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::findEnts(const std::vector<EntityId>& ids, EntVec& out) const {
+  for (auto eid : ids) {
+    if (isAlive(eid)) { s__conj(out, ent(eid)); }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+EntityId Engine::spawn() {
+  uint32_t i;
+  if (_free.empty()) {
+    i= (uint32_t)_gens.size();
+    s__conj(_gens, 1);
+    _objs.resize(i+1);
+    _sigs.resize(_sigs.size() + _sigWords, 0);
+  } else {
+    i= _free.back();
+    _free.pop_back();
+  }
+  _gens[i] |= GEN_LIVE;
+  ECS_PROF_COUNT(_prof, P_SPAWN, 1);
+  auto eid= entHandle(i, _gens[i] & ~GEN_LIVE);
+  for (auto v : _open) { v->add(eid); }
+  return eid;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::kill(uint32_t i) {
+  ECS_PROF_COUNT(_prof, P_PURGE, 1);
+  bury(i);
+  std::fill_n(_sigs.data() + i*_sigWords, _sigWords, 0);
+  s__conj(_free, i);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::bury(uint32_t i) {
+  auto& o= _objs[i];
+  if (o.isSome()) {
+    o->die();
+    s__conj(_garbo, o);
+    o= EEntity();
+  }
+  // stale handles stop matching, generation 0 is never used
+  auto g= (_gens[i] + 1) & ~GEN_LIVE;
+  _gens[i]= g == 0 ? 1 : g;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::widen(Cid cid) {
+  size_t w= cid/64 + 1;
+  if (w <= _sigWords) { return; }
+  std::vector<uint64_t> s(_gens.size() * w, 0);
+  for (size_t i=0; i < _gens.size(); ++i) {
+    std::copy_n(_sigs.data() + i*_sigWords, _sigWords, s.data() + i*w);
+  }
+  _sigs.swap(s);
+  _sigWords= w;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+bool Engine::hasAll(EntityId eid, const std::vector<Cid>& cs) const {
+  if (!isAlive(eid)) { return false; }
+  auto s= _sigs.data() + entIndex(eid) * _sigWords;
+  for (auto cid : cs) {
+    if ((size_t)cid/64 >= _sigWords ||
+        (s[cid/64] & (1ULL << (cid%64))) == 0) { return false; }
+  }
+  return true;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+bool Engine::has(EntityId eid, Cid cid) const {
+  return isAlive(eid) &&
+         (size_t)cid/64 < _sigWords &&
+         (_sigs[entIndex(eid)*_sigWords + cid/64] & (1ULL << (cid%64))) != 0;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+bool Engine::matches(EntityId eid, const Filter& f) const {
+  if (!hasAll(eid, f.all)) { return false; }
+  for (auto cid : f.none) {
+    if (has(eid, cid)) { return false; }
+  }
+  return true;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+Filter& Filter::normalize() {
+  for (auto v : { &all, &none }) {
+    std::sort(v->begin(), v->end());
+    v->erase(std::unique(v->begin(), v->end()), v->end());
+  }
+  return *this;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+EntVec Engine::getEnts(const Filter& f) const {
+  std::vector<EntityId> ids;
   EntVec out;
-  MapEidC* pm;
-  auto pmin= LONG_MAX;
-
-  //find shortest cache, doing an intersection
-  for (auto& cid : cs) {
-    auto c= _types->getCache(cid);
-    if (E_NIL(c)) {
-      DEBUG("cache missed on %s", N_STR(cid).c_str());
-      return out;
-    }
-    if (c->size() < pmin) {
-      pmin= c->size();
-      pm=c;
-    }
-    s__conj(ccs, c);
-  }
-
-  DEBUG("intesection on %d caches", (int)ccs.size());
-
-  if (ccs.size() > 0) {
-    //use the shortest cache as the baseline
-    for (auto i= pm->begin(),e= pm->end();i != e;++i) {
-      auto eid= i->first;
-      auto sum=0;
-      for (auto& c : ccs) {
-        // look for intersection
-        if (c == pm) { ++sum; continue; }
-        if (s__contains(*c, eid)) { ++sum; }
+  query(f, ids);
+  findEnts(ids, out);
+  return out;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::query(const std::vector<Cid>& cs, std::vector<EntityId>& out) const {
+  if (cs.empty()) { return; }
+  query(Filter{ cs, {} }, out);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::query(const Filter& f, std::vector<EntityId>& out) const {
+  auto w= _sigWords;
+  std::vector<uint64_t> req(w, 0);
+  std::vector<uint64_t> bar(w, 0);
+  for (auto cid : f.all) {
+    // nobody has a type this new
+    if ((size_t)cid/64 >= w) { return; }
+    req[cid/64] |= 1ULL << (cid%64);
+  }
+  for (auto cid : f.none) {
+    // nor is anybody kept out by it
+    if ((size_t)cid/64 < w) { bar[cid/64] |= 1ULL << (cid%64); }
+  }
+#if ECS_PROFILE
+  auto n0= out.size();
+#endif
+
+  // flag a block of slots first, that loop has no branches and
+  // vectorizes, then pick out the hits.  Dead slots have no bits
+  // so they never match, unless nothing is required
+  auto any= f.all.empty();
+  const size_t B= 1024;
+  uint8_t hit[B];
+  auto sig= _sigs.data();
+  auto n= _gens.size();
+  auto gens= _gens.data();
+  for (size_t b=0; b < n; b += B) {
+    auto z= std::min(B, n-b);
+    auto s= sig + b*w;
+    if (w == 2) {
+      auto r0= req[0], r1= req[1];
+      auto x0= bar[0], x1= bar[1];
+      for (size_t i=0; i < z; ++i) {
+        auto s0= s[2*i], s1= s[2*i+1];
+        hit[i]= (((s0 & r0) ^ r0) | ((s1 & r1) ^ r1) | (s0 & x0) | (s1 & x1)) == 0;
       }
-      // if found in all caches...matched!
-      if (sum == ccs.size()) {
-        if (auto it4= _ents.find(eid); it4 != _ents.end()) {
-          s__conj(out,it4->second);
+    } else {
+      for (size_t i=0; i < z; ++i) {
+        uint64_t miss=0;
+        for (size_t k=0; k < w; ++k) {
+          miss |= ((s[i*w+k] & req[k]) ^ req[k]) | (s[i*w+k] & bar[k]);
         }
+        hit[i]= miss == 0;
+      }
+    }
+    for (size_t i=0; i < z; ++i) {
+      if (hit[i] && (!any || (gens[b+i] & GEN_LIVE))) {
+        s__conj(out, entHandle((uint32_t)(b+i), gens[b+i] & ~GEN_LIVE));
       }
     }
   }
+  ECS_PROF_QUERY(_prof, f.all, out.size() - n0);
+}
 
-  return out;
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+EEntity Engine::ent(EntityId eid) const {
+  if (!isAlive(eid)) {
+    return EEntity();
+  }
+  auto& o= _objs[entIndex(eid)];
+  if (o.isNone()) {
+    o= new Entity(const_cast<Engine*>(this), eid);
+  }
+  return o;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+View* Engine::view(const std::vector<Cid>& cs) {
+  return view(Filter{ cs, {} });
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+View* Engine::view(const Filter& f) {
+  auto sig= f;
+  sig.normalize();
+  if (auto i= _views.find(sig); i != _views.end()) {
+    return i->second;
+  }
+  auto v= new View(this, sig);
+  _views.insert(s__pair(Filter,View*,sig,v));
+  // binding a without type can push an entity out, and
+  // unbinding it let one in
+  for (auto cs : { &sig.all, &sig.none }) {
+    for (auto cid : *cs) {
+      if (cid >= (Cid)_viewsByCid.size()) {
+        _viewsByCid.resize(cid+1);
+      }
+      s__conj(_viewsByCid[cid], v);
+    }
+  }
+  // nothing to bind, so only spawns can let one in
+  if (sig.all.empty()) { s__conj(_open, v); }
+  return v;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::bound(EntityId eid, Cid cid) {
+  if (!isAlive(eid)) { return; }
+  ECS_PROF_COUNT(_prof, P_BIND, 1);
+  widen(cid);
+  _sigs[entIndex(eid)*_sigWords + cid/64] |= 1ULL << (cid%64);
+  stamp(changes(cid), entIndex(eid));
+  if (watched(cid)) { s__conj(_pending, (Event{ cid, eid, true })); }
+  if (cid < (Cid)_viewsByCid.size()) {
+    for (auto v : _viewsByCid[cid]) {
+      if (v->matches(eid)) { v->add(eid); } else { v->remove(eid); }
+    }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::unbound(EntityId eid, Cid cid) {
+  ECS_PROF_COUNT(_prof, P_UNBIND, 1);
+  if (isAlive(eid) && (size_t)cid/64 < _sigWords) {
+    auto& w= _sigs[entIndex(eid)*_sigWords + cid/64];
+    auto bit= 1ULL << (cid%64);
+    if ((w & bit) && watched(cid)) {
+      s__conj(_pending, (Event{ cid, eid, false }));
+    }
+    w &= ~bit;
+  }
+  if (cid < (Cid)_viewsByCid.size()) {
+    for (auto v : _viewsByCid[cid]) {
+      if (v->matches(eid)) { v->add(eid); } else { v->remove(eid); }
+    }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+Engine::ChangeLog* Engine::changes(Cid cid) {
+  if (cid >= (Cid)_changes.size()) {
+    _changes.resize(cid+1, NULL);
+  }
+  if (E_NIL(_changes[cid])) {
+    _changes[cid]= new ChangeLog();
+  }
+  return _changes[cid];
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::stamp(ChangeLog* c, uint32_t i) {
+  std::lock_guard<std::mutex> g(c->lock);
+  auto t= _tick.load(std::memory_order_relaxed);
+  if (i >= c->at.size()) {
+    c->at.resize(std::max((size_t)i+1, _gens.size()), 0);
+  }
+  // once per slot per tick
+  if (c->at[i] == t) { return; }
+  c->at[i]= t;
+  s__conj(c->log, std::make_pair(t, i));
+  trim(c);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::stamp(ChangeLog* c, const EntityId* eids, size_t n) {
+  // same as one by one, with the log grown once
+  std::lock_guard<std::mutex> g(c->lock);
+  auto t= _tick.load(std::memory_order_relaxed);
+  c->at.resize(std::max(c->at.size(), _gens.size()), 0);
+  c->log.reserve(c->log.size() + n);
+  for (size_t k=0; k < n; ++k) {
+    auto i= entIndex(eids[k]);
+    if (c->at[i] != t) {
+      c->at[i]= t;
+      c->log.emplace_back(t, i);
+    }
+  }
+  trim(c);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::trim(ChangeLog* c) {
+  // drop the entries made stale by a later change, which
+  // keeps the log no longer than about twice the slots
+  if (c->log.size() > 2*c->at.size() + 1024) {
+    auto& at= c->at;
+    c->log.erase(std::remove_if(c->log.begin(), c->log.end(),
+                                [&at](auto& x) { return at[x.second] != x.first; }),
+                 c->log.end());
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::touched(EntityId eid, Cid cid) {
+  // nothing to flag unless the entity has it, and then
+  // bound() has made the log already
+  if (!isAlive(eid) ||
+      (size_t)cid/64 >= _sigWords ||
+      cid >= (Cid)_changes.size() || E_NIL(_changes[cid])) { return; }
+  auto i= entIndex(eid);
+  if (_sigs[i*_sigWords + cid/64] & (1ULL << (cid%64))) {
+    stamp(_changes[cid], i);
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+uint64_t Engine::changed(Cid cid, uint64_t since, std::vector<EntityId>& out) {
+  if (cid >= (Cid)_changes.size() || E_NIL(_changes[cid])) { return ++_tick; }
+  auto c= _changes[cid];
+  std::lock_guard<std::mutex> g(c->lock);
+  // whatever changes from here on gets a newer tick
+  auto next= ++_tick;
+  if (c->all >= since) {
+    query(std::vector<Cid>{ cid }, out);
+    return next;
+  }
+  auto i= std::lower_bound(c->log.begin(), c->log.end(), std::make_pair(since, (uint32_t)0));
+  auto bit= 1ULL << (cid%64);
+  auto word= cid/64;
+  for (auto e= c->log.end(); i != e; ++i) {
+    auto x= i->second;
+    // skip the stale ones, and slots which lost the component
+    if (c->at[x] == i->first && (_sigs[x*_sigWords + word] & bit)) {
+      s__conj(out, entHandle(x, _gens[x] & ~GEN_LIVE));
+    }
+  }
+  return next;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::forget() {
+  for (auto c : _changes) {
+    if (X_NIL(c)) {
+      c->at.clear();
+      c->log.clear();
+      c->all=0;
+    }
+  }
 }
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 EntVec Engine::getEnts() const {
   EntVec out;
-  for (auto i=_ents.begin(),e= _ents.end();i != e; ++i) {
-    s__conj(out, i->second);
+  for (uint32_t i=0; i < _gens.size(); ++i) {
+    if (_gens[i] & GEN_LIVE) {
+      s__conj(out, ent(entHandle(i, _gens[i] & ~GEN_LIVE)));
+    }
   }
   return out;
 }
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 EEntity Engine::reifyEnt(const stdstr& n, bool take) {
-  auto e= new Entity(this, n);
-  _ents.insert(s__pair(EntityId,EEntity,e->id(),e));
-  //if (take) {e->take();}
+  auto eid= spawn();
+  EEntity e;
+  if (take && !_spare.empty()) {
+    e= _spare.back();
+    _spare.pop_back();
+    e->revive(eid, n);
+  } else {
+    e= new Entity(this, eid, n);
+  }
+  _objs[entIndex(eid)]= e;
   return e;
 }
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 EEntity Engine::reifyEnt(bool take) {
-  auto e= new Entity(this);
-  _ents.insert(s__pair(EntityId,EEntity,e->id(),e));
-  //if (take) {e->take();}
-  return e;
+  return take ? reifyEnt("", true) : ent(spawn());
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::recycle() {
+  // dead objects nobody else holds on to can be handed out
+  // again by reifyEnt(take), the rest go back to the pool
+  for (auto& e : _garbo) {
+    if (e->refs() == 1 && _spare.size() < MAX_SPARE) {
+      s__conj(_spare, e);
+    }
+  }
+  _garbo.clear();
 }
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 void Engine::purgeEnt(EEntity e) {
   assert(e.isSome());
+  purgeEnt(e->id());
   e->die();
-  s__conj(_garbo, e);
+}
 
-  if (auto i= _ents.find(e->id()); i != _ents.end()) {
-    _ents.erase(i);
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::purgeEnt(EntityId eid) {
+  if (!isAlive(eid)) { return; }
+  if (has(eid, EntityFeature<Relation>::id())) {
+    purgeEnts(std::vector<EntityId>{ eid });
+  } else {
+    erase(eid);
   }
 }
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
-void Engine::purgeEnts() {
-  _garbo.clear();
-  _ents.clear();
+void Engine::erase(EntityId eid) {
+  if (!isAlive(eid)) { return; }
+  dropped(entIndex(eid), eid);
+  _types->purge(eid);
+  _types->dropPods(eid);
+  for (auto i=_views.begin(),z=_views.end();i != z;++i) {
+    i->second->remove(eid);
+  }
+  kill(entIndex(eid));
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::purgeEnts(const std::vector<EntityId>& arg) {
+  std::vector<EntityId> tree;
+  auto& eids= uproot(arg, tree) ? tree : arg;
+  // removing one from a column is O(1) already, a sweep only
+  // pays when it takes out a good part of the world
+  if (eids.size() * 2 < count()) {
+    for (auto e : eids) { erase(e); }
+    return;
+  }
+  std::vector<uint8_t> dead(_gens.size(), 0);
+  size_t n=0;
+  for (auto e : eids) {
+    auto i= entIndex(e);
+    if (isAlive(e) && !dead[i]) {
+      dead[i]=1;
+      dropped(i, e);
+      ++n;
+    }
+  }
+  if (n == 0) { return; }
+  _types->sweep(dead);
+  _types->sweepPods(dead);
+  for (auto i=_views.begin(),z=_views.end();i != z;++i) {
+    i->second->sweep(dead);
+  }
+  for (auto e : eids) {
+    auto i= entIndex(e);
+    // once each, repeats are cleared on the way
+    if (dead[i]) {
+      dead[i]=0;
+      kill(i);
+    }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::purgeEnts(const Filter& f) {
+  std::vector<EntityId> eids;
+  query(f, eids);
+  purgeEnts(eids);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::clearWorld() {
+  for (auto i=_views.begin(),e=_views.end();i != e;++i) {
+    i->second->clear();
+  }
+  // observers still hear of every removal
+  if (!_watched.empty()) {
+    for (uint32_t i=0; i < _gens.size(); ++i) {
+      if (_gens[i] & GEN_LIVE) { dropped(i, entHandle(i, _gens[i] & ~GEN_LIVE)); }
+    }
+  }
+  ECS_PROF_COUNT(_prof, P_PURGE, count());
+  _types->clear();
+  _types->clearPods();
+  // the whole table is free, low slots handed out first
+  _free.clear();
+  for (auto i= (uint32_t)_gens.size(); i-- > 0;) {
+    if (_gens[i] & GEN_LIVE) { bury(i); }
+    s__conj(_free, i);
+  }
+  std::fill(_sigs.begin(), _sigs.end(), 0);
+  forget();
+  recycle();
 }
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
@@ -131,20 +575,22 @@ ESystem Engine::addSystem(ESystem arg) {
   auto i= _systems.begin();
   auto e= _systems.end();
   for (; i != e; ++i) {
-    auto s= *i;
+    auto& s= *i;
     if (p > s->priority())
     break;
   }
   _systems.insert(i,arg);
+  if (_sched) { _sched->reset(); }
   return arg;
 }
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 void Engine::purgeSystem(ESystem s) {
   for (auto i= _systems.begin(), e= _systems.end(); i != e; ++i) {
-    auto p= *i;
+    auto& p= *i;
     if (p.ptr()== s.ptr()) {
       _systems.erase(i);
+      if (_sched) { _sched->reset(); }
       s=NULL;
       break;
     }
@@ -154,26 +600,186 @@ void Engine::purgeSystem(ESystem s) {
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 void Engine::purgeSystems() {
   _systems.clear();
+  if (_sched) { _sched->reset(); }
 }
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 void Engine::update(float time) {
+  ECS_PROF_FRAME(_prof);
+  ++_tick;
   _updating = true;
-  for (auto i=_systems.begin(),e=_systems.end();i != e;++i) {
-    auto s= *i;
-    if (s->isActive()) {
-      if (! s->update(time)) { break; }
+  if (_sched) {
+    _sched->run(time);
+  } else {
+    // by reference, a copy of the RefPtr would bump the count
+    for (auto i=_systems.begin(),e=_systems.end();i != e;++i) {
+      auto& s= *i;
+      if (s->isActive()) {
+        ECS_PROF_SYSTEM(_prof, s.ptr());
+        if (! s->run(time, _maxSteps)) { break; }
+      }
     }
   }
-  _garbo.clear();
+  flush();
+  notify();
+  recycle();
   _updating = false;
 }
 
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::observe(Cid cid, Observer* o) {
+  if (cid >= (Cid)_observers.size()) {
+    _observers.resize(cid+1);
+  }
+  auto& v= _observers[cid];
+  if (std::find(v.begin(), v.end(), o) != v.end()) { return; }
+  if (v.empty()) { s__conj(_watched, cid); }
+  s__conj(v, o);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::unobserve(Observer* o) {
+  for (auto& v : _observers) {
+    v.erase(std::remove(v.begin(), v.end(), o), v.end());
+  }
+  _watched.erase(std::remove_if(_watched.begin(), _watched.end(),
+                                [this](Cid c) { return !watched(c); }),
+                 _watched.end());
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::dropped(uint32_t i, EntityId eid) {
+  // the registry purge is silent, so go by the signature
+  auto s= _sigs.data() + i*_sigWords;
+  for (auto cid : _watched) {
+    if ((size_t)cid/64 < _sigWords && (s[cid/64] & (1ULL << (cid%64)))) {
+      s__conj(_pending, (Event{ cid, eid, false }));
+    }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::notify() {
+  if (_notifying) { return; }
+  _notifying=true;
+  // observers which change things make more events, keep
+  // going a few rounds, the rest waits for the next update
+  for (auto round=0; round < 8 && !_pending.empty(); ++round) {
+    // both buffers keep their capacity, so no allocation
+    // once things settle
+    _sending.swap(_pending);
+    for (auto& e : _sending) {
+      // observers may (un)observe as they go, so look again
+      // every time round
+      for (size_t k=0; k < _observers[e.cid].size(); ++k) {
+        auto o= _observers[e.cid][k];
+        if (e.added) {
+          o->onAdd(e.cid, e.eid);
+        } else {
+          o->onRemove(e.cid, e.eid);
+        }
+      }
+    }
+    _sending.clear();
+  }
+  _notifying=false;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::parallel(int workers) {
+  DEL_PTR(_sched);
+  if (workers > 0) {
+    _sched= new Scheduler(this, workers);
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+Jobs* Engine::jobs() const {
+  return _sched ? _sched->jobs() : NULL;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+Commands* Engine::cmds() {
+  for (auto& s : _myCmds) {
+    if (s.serial == _serial) { return s.cmds; }
+  }
+  auto c= new Commands();
+  {
+    std::lock_guard<std::mutex> g(_cmdLock);
+    s__conj(_cmdbufs, c);
+  }
+  s__conj(_myCmds, (CmdSlot{ _serial, c }));
+  return c;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::flush() {
+  std::vector<Commands::Cmd> all;
+  std::vector<EntityId> made;
+  std::vector<Commands*> bufs;
+  // values of add()s from every buffer
+  std::vector<char> bytes;
+  {
+    std::lock_guard<std::mutex> g(_cmdLock);
+    bufs= _cmdbufs;
+  }
+  // resolve placeholders, buffer by buffer
+  for (auto b : bufs) {
+    if (b->isEmpty()) { continue; }
+    made.clear();
+    for (size_t i=0; i < b->_made; ++i) {
+      s__conj(made, spawn());
+    }
+    for (auto& c : b->_cmds) {
+      if (c.eid < 0) {
+        // one made this time, or by an earlier flush
+        auto k= (size_t)(-c.eid - 1);
+        c.eid= k >= b->_base ? made[k - b->_base] : b->resolve(c.eid);
+        if (c.eid == 0) { continue; }
+      }
+      c.seq= all.size();
+      c.at += bytes.size();
+      s__conj(all, c);
+    }
+    bytes.insert(bytes.end(), b->_bytes.begin(), b->_bytes.end());
+    // kept for resolve() until the next lot
+    if (b->_made > 0) {
+      b->_resolved= made;
+      b->_was= b->_base;
+      b->_base += b->_made;
+    }
+    b->clear();
+  }
+  if (all.empty()) { return; }
+
+  // purges go last, everything else is grouped by type
+  // then entity so each store is touched in key order
+  std::sort(all.begin(), all.end(),
+            [](const Commands::Cmd& x, const Commands::Cmd& y) {
+    auto px= x.op == C_PURGE, py= y.op == C_PURGE;
+    if (px != py) { return py; }
+    if (x.cid != y.cid) { return x.cid < y.cid; }
+    if (x.eid != y.eid) { return x.eid < y.eid; }
+    return x.seq < y.seq;
+  });
+
+  std::vector<EntityId> dead;
+  for (auto& c : all) {
+    switch (c.op) {
+      case C_BIND: _types->attach(c.cid, c.eid, c.c); break;
+      case C_UNBIND: _types->detach(c.cid, c.eid); break;
+      case C_APPLY: c.fn(_types, c.eid, bytes.data() + c.at); break;
+      case C_PURGE: s__conj(dead, c.eid); break;
+    }
+  }
+  if (!dead.empty()) { purgeEnts(dead); }
+}
+
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 void Engine::ignite() {
   (initEnts(), initSystems());
   for (auto i= _systems.begin(),e= _systems.end();i != e;++i) {
-    auto s= *i;
+    auto& s= *i;
     s->preamble();
   }
 }
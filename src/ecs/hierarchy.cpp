@@ -0,0 +1,178 @@
+/* Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
+
+#include "hierarchy.h"
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+namespace czlab::ecs {
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// append the subtree below out[from..], breadth first so every
+// parent comes before its children
+static void expand(SparseSet<Relation>* t, std::vector<EntityId>& out, size_t from) {
+  for (auto k=from; k < out.size(); ++k) {
+    for (auto c= t->get(out[k])->first; c != 0; c= t->get(c)->next) {
+      s__conj(out, c);
+    }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// move the subtree of e to depth, touching whatever changed
+static void reroot(Registry* r, SparseSet<Relation>* t, EntityId e, uint32_t depth) {
+  auto d= t->get(e)->depth;
+  if (d == depth) { return; }
+  std::vector<EntityId> sub{ e };
+  expand(t, sub, 0);
+  for (auto x : sub) {
+    auto p= t->get(x);
+    p->depth= p->depth - d + depth;
+    r->touch<Relation>(x);
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// cut e from its parent, touching e, the siblings on either
+// side and the parent if its first child was e
+void Engine::unlink(SparseSet<Relation>* t, EntityId e) {
+  auto r= t->get(e);
+  if (r->parent == 0) { return; }
+  if (r->prev != 0) {
+    t->get(r->prev)->next= r->next;
+    _types->touch<Relation>(r->prev);
+  } else if (auto p= t->get(r->parent); X_NIL(p)) {
+    p->first= r->next;
+    _types->touch<Relation>(r->parent);
+  }
+  if (r->next != 0) {
+    t->get(r->next)->prev= r->prev;
+    _types->touch<Relation>(r->next);
+  }
+  r->parent= r->prev= r->next= 0;
+  _types->touch<Relation>(e);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+bool Engine::adopt(EntityId parent, EntityId child) {
+  if (parent == child || !isAlive(parent) || !isAlive(child)) { return false; }
+  // no cycles, the child may not be above its new parent
+  for (auto p= parentOf(parent); p != 0; p= parentOf(p)) {
+    if (p == child) { return false; }
+  }
+  auto t= _types->reifyColumn<Relation>();
+  // both added before taking pointers, adding may move the data
+  if (!t->has(parent)) { _types->add<Relation>(parent, Relation()); }
+  if (!t->has(child)) { _types->add<Relation>(child, Relation()); }
+  unlink(t, child);
+  auto p= t->get(parent);
+  auto c= t->get(child);
+  c->parent= parent;
+  c->next= p->first;
+  if (p->first != 0) {
+    t->get(p->first)->prev= child;
+    _types->touch<Relation>(p->first);
+  }
+  p->first= child;
+  _types->touch<Relation>(parent);
+  _types->touch<Relation>(child);
+  reroot(_types, t, child, p->depth + 1);
+  return true;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::orphan(EntityId e) {
+  auto t= _types->column<Relation>();
+  auto r= X_NIL(t) && isAlive(e) ? t->get(e) : NULL;
+  if (E_NIL(r) || r->parent == 0) { return; }
+  unlink(t, e);
+  reroot(_types, t, e, 0);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+EntityId Engine::parentOf(EntityId e) const {
+  auto t= _types->column<Relation>();
+  auto r= X_NIL(t) ? t->get(e) : NULL;
+  return E_NIL(r) ? 0 : r->parent;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::children(EntityId e, std::vector<EntityId>& out) const {
+  auto t= _types->column<Relation>();
+  auto r= X_NIL(t) ? t->get(e) : NULL;
+  if (E_NIL(r)) { return; }
+  for (auto c= r->first; c != 0; c= t->get(c)->next) {
+    s__conj(out, c);
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::descendants(EntityId e, std::vector<EntityId>& out) const {
+  auto n= out.size();
+  children(e, out);
+  auto t= _types->column<Relation>();
+  if (out.size() > n) { expand(t, out, n); }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+SparseSet<Relation>* Engine::hierarchy() {
+  auto t= _types->reifyColumn<Relation>();
+  // adopt() and purges leave it mostly in order, checking is
+  // one pass over the links
+  auto& rs= t->data();
+  if (!std::is_sorted(rs.begin(), rs.end(), shallower)) {
+    t->sort(shallower);
+  }
+  return t;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+bool Engine::uproot(const std::vector<EntityId>& in, std::vector<EntityId>& out) {
+  auto t= _types->column<Relation>();
+  if (E_NIL(t) || t->size() == 0) { return false; }
+  // a subtree already taken is not walked again, else purging
+  // every node of a deep tree would be quadratic
+  std::vector<uint8_t> seen(in.size() > 1 ? _gens.size() : 0, 0);
+  for (auto e : in) {
+    if (!isAlive(e)) { continue; }
+    auto i= entIndex(e);
+    if (!seen.empty()) {
+      if (seen[i]) { continue; }
+      seen[i]=1;
+    }
+    auto n= out.size();
+    s__conj(out, e);
+    if (!t->has(e)) { continue; }
+    for (auto k=n; k < out.size(); ++k) {
+      for (auto c= t->get(out[k])->first; c != 0; c= t->get(c)->next) {
+        auto j= entIndex(c);
+        if (!seen.empty()) {
+          if (seen[j]) { continue; }
+          seen[j]=1;
+        }
+        s__conj(out, c);
+      }
+    }
+  }
+  for (auto e : out) {
+    if (t->has(e)) { unlink(t, e); }
+  }
+  return true;
+}
+
+
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+//EOF
+
@@ -0,0 +1,61 @@
+#pragma once
+/* Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
+
+//////////////////////////////////////////////////////////////////////////////
+// Parent/child links between entities, e.g. transforms or who
+// owns what
+//
+//   g->adopt(ship, turret);
+//   auto t= g->hierarchy();
+//   auto& ids= t->ids();
+//   auto& rs= t->data();
+//   for (size_t i=0; i < ids.size(); ++i) {
+//     if (rs[i].parent != 0) { world(ids[i])= world(rs[i].parent) * local(ids[i]); }
+//   }
+//
+// The links are a by value component, so with<Relation>() and
+// observers work as usual.  Change them through the engine
+// only, never add() or erase() a Relation by hand.
+
+#include "pod.h"
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+namespace czlab::ecs {
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// Where an entity sits in its tree, 0 for none.  Children form
+// a list from first, linked both ways so one can leave in O(1)
+struct Relation {
+  EntityId parent=0;
+  EntityId first=0;
+  EntityId next=0;
+  EntityId prev=0;
+  // 0 for roots
+  uint32_t depth=0;
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// the order of Engine::hierarchy(), siblings end up side by side
+inline bool shallower(const Relation& a, const Relation& b) {
+  return a.depth < b.depth ||
+         (a.depth == b.depth && entIndex(a.parent) < entIndex(b.parent));
+}
+
+
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+//EOF
+
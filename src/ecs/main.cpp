@@ -33,15 +33,9 @@ struct Health : public e::Component {
   virtual ~Health() {}
 };
 
-struct Flyable : public e::Component {
-  Flyable() {}
-  virtual ~Flyable() {}
-};
-
-struct Runnable : public e::Component {
-  Runnable() {}
-  virtual ~Runnable() {}
-};
+// tags, nothing but a bit in the signature
+struct Flyable {};
+struct Runnable {};
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 struct S1 : public e::System {
@@ -108,8 +102,8 @@ struct Game : public e::Engine {
     rego()->bind<Health>(new Health(),a);
     rego()->bind<Health>(new Health(),b);
 
-    rego()->bind<Runnable>(new Runnable(),a);
-    rego()->bind<Flyable>(new Flyable(),b);
+    rego()->tag<Runnable>(a->id());
+    rego()->tag<Flyable>(b->id());
   }
 
   virtual void initSystems() {
@@ -121,20 +115,30 @@ struct Game : public e::Engine {
 };
 
 
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// see bench.cpp
+int bench(int, char**);
+
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 }
 
 using namespace czlab::ecs;
 
 int main(int ac, char** av) {
+  if (ac > 1 && stdstr(av[1]) == "bench") {
+    return bench(ac, av);
+  }
   Game* g = new Game();
   g->ignite();
   g->update(1);
 
+  auto w= g->getEnts(with<Health>().without<Flyable>());
+  std::cout << "grounded = " << w.size() << "\n";
+
   auto rc= g->getEnts();
   for (auto & i : rc) {
-    std::cout << "eid = " << i->id() << "\n";
-    g->rego()->unbind<Flyable>(i);
+    std::cout << "eid = " << i->name() << "\n";
+    g->rego()->untag<Flyable>(i->id());
   }
 
 
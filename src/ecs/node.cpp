@@ -17,18 +17,27 @@
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 namespace czlab::ecs {
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
-static EntityId _lastNodeId=0;
-
-//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
-Entity::Entity(Engine* e, const stdstr& n) : Entity (e) {
+Entity::Entity(Engine* e, EntityId eid, const stdstr& n) : Entity (e, eid) {
   this->_name=n;
 }
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
-Entity::Entity(Engine* e) {
+Entity::Entity(Engine* e, EntityId eid) {
   _engine=e;
-  _eid = ++_lastNodeId;
-  _name = "node#" + std::to_string(_eid);
+  _eid = eid;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Entity::revive(EntityId eid, const stdstr& n) {
+  _dead=false;
+  _eid=eid;
+  _name=n;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+stdstr Entity::name() const {
+  // only pay for the default name when asked
+  return _name.empty() ? "node#" + std::to_string(entIndex(_eid)) : _name;
 }
 
 
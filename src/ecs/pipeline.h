@@ -0,0 +1,127 @@
+#pragma once
+/* Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
+
+//////////////////////////////////////////////////////////////////////////////
+// Systems fixed at compile time, run in the order given
+//
+//   g->addSystem(new Pipeline<Input,Move,Collide>(g, 100));
+//
+// The members live inside the pipeline and are called by type,
+// so the engine makes one virtual call for the lot and each
+// update() can be inlined.  A member needs a constructor taking
+// the Engine*, its priority() is not used.  The same type may
+// appear more than once, e.g. Pipeline<Move,Collide,Move>.
+
+#include <tuple>
+#include <utility>
+#include "profile.h"
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+namespace czlab::ecs {
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename... S>
+struct Pipeline final : public System {
+
+  static_assert((std::is_base_of_v<System,S> && ...), "members must be systems");
+
+  // stops at the first member whose update() says false
+  virtual bool update(float time) {
+    return update(time, Seq());
+  }
+
+  virtual void preamble() {
+    preamble(Seq());
+  }
+
+  virtual int priority() const { return _priority; }
+
+  // a member, e.g. to suspend() it
+  template<size_t I>
+  auto& get() { return std::get<I>(_ss); }
+
+  // the first member of type T
+  template<typename T>
+  T& get() { return std::get<indexOf<T>()>(_ss); }
+
+  Pipeline(Engine* e, int priority=0) : System(e), _ss(engineFor<S>(e)...) {
+    _priority= priority;
+    declare(Seq());
+  }
+
+  virtual ~Pipeline() {}
+
+  private:
+
+  typedef std::index_sequence_for<S...> Seq;
+
+  template<size_t... I>
+  bool update(float time, std::index_sequence<I...>) {
+    return (step(std::get<I>(_ss), time) && ...);
+  }
+
+  template<size_t... I>
+  void preamble(std::index_sequence<I...>) {
+    (std::get<I>(_ss).S::preamble(), ...);
+  }
+
+  // what the members touch, as one system to the scheduler
+  template<size_t... I>
+  void declare(std::index_sequence<I...>) {
+    if (!(std::get<I>(_ss).declared() && ...)) { return; }
+    _declared=true;
+    (_reads.insert(_reads.end(),
+                   std::get<I>(_ss).readSet().begin(),
+                   std::get<I>(_ss).readSet().end()), ...);
+    (_writes.insert(_writes.end(),
+                    std::get<I>(_ss).writeSet().begin(),
+                    std::get<I>(_ss).writeSet().end()), ...);
+  }
+
+  template<typename T>
+  static constexpr size_t indexOf() {
+    static_assert((std::is_same_v<T,S> || ...), "not a member");
+    constexpr bool hit[]= { std::is_same_v<T,S>... };
+    size_t k=0;
+    while (!hit[k]) { ++k; }
+    return k;
+  }
+
+  template<typename T>
+  static Engine* engineFor(Engine* e) { return e; }
+
+  template<typename T>
+  bool step(T& s, float time) {
+    if (!s.isActive()) { return true; }
+    ECS_PROF_SYSTEM(_engine->profiler(), &s);
+    if (s.step() <= 0) {
+      return s.T::update(time);
+    }
+    for (auto i=0, n= s.due(time, _engine->maxSteps()); i < n; ++i) {
+      if (! s.T::update(s.step())) { return false; }
+    }
+    return true;
+  }
+
+  std::tuple<S...> _ss;
+  int _priority;
+};
+
+
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+//EOF
+
@@ -0,0 +1,153 @@
+#pragma once
+/* Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
+
+//////////////////////////////////////////////////////////////////////////////
+
+#include <type_traits>
+#include "sparse.h"
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+namespace czlab::ecs {
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// true for types which go into the by value storage
+template<typename T>
+inline constexpr bool isPod= !std::is_base_of_v<Component,T> && !isTag<T>;
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+struct TypedColumn : public Column {
+
+  static_assert(std::is_trivially_copyable_v<T>,
+                "by value components must be trivially copyable");
+
+  virtual size_t size() const { return set.size(); }
+  virtual size_t stride() const { return sizeof(T); }
+  virtual const std::vector<EntityId>& ids() const { return set.ids(); }
+  virtual const void* data() const { return set.values(); }
+
+  virtual bool has(EntityId eid) const { return set.has(eid); }
+  virtual const void* at(EntityId eid) const { return set.get(eid); }
+  virtual bool remove(EntityId eid) { return set.remove(eid); }
+  virtual void clear() { set.clear(); }
+  virtual void sweep(const std::vector<uint8_t>& dead) { set.sweep(dead); }
+
+  virtual void load(const EntityId* eids, const void* vs, size_t n) {
+    set.load(eids, (const T*) vs, n);
+  }
+
+  virtual void fill(const EntityId* eids, const void* v, size_t n) {
+    set.fill(eids, *(const T*) v, n);
+  }
+
+  virtual void borrow(std::vector<EntityId>& eids, const void* vs) {
+    // snapshot records are only 8 byte aligned
+    if constexpr (alignof(T) > 8) {
+      set.load(eids.data(), (const T*) vs, eids.size());
+    } else {
+      set.borrow(eids, (const T*) vs);
+    }
+  }
+
+  SparseSet<T> set;
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+SparseSet<T>* Registry::column() const {
+  auto c= column(EntityFeature<T>::id());
+  return E_NIL(c) ? NULL : &s__cast(TypedColumn<T>, c)->set;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+SparseSet<T>* Registry::reifyColumn() {
+  auto cid= EntityFeature<T>::id();
+  if (cid >= (Cid)_pods.size()) {
+    _pods.resize(cid+1, NULL);
+  }
+  if (E_NIL(_pods[cid])) {
+    _pods[cid]= new TypedColumn<T>();
+  }
+  return &s__cast(TypedColumn<T>, _pods[cid])->set;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+T* Registry::add(EntityId eid, const T& v) {
+  static_assert(!isTag<T>, "use tag() for empty types");
+  static_assert(isPod<T>, "use bind() for Component types");
+  // a stale handle, storing would leave a record no entity owns
+  if (_engine && !_engine->isAlive(eid)) { return NULL; }
+  auto s= reifyColumn<T>();
+  if (auto p= s->get(eid); X_NIL(p)) {
+    *p= v;
+    touch<T>(eid);
+    return p;
+  }
+  s->add(eid, v);
+  if (_engine) { _engine->bound(eid, EntityFeature<T>::id()); }
+  return s->get(eid);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+T* Registry::tryGet(EntityId eid) {
+  auto s= column<T>();
+  return E_NIL(s) ? NULL : s->get(eid);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+T& Registry::get(EntityId eid) {
+  auto p= tryGet<T>(eid);
+  assert(X_NIL(p));
+  return *p;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+T& Registry::edit(EntityId eid) {
+  auto& v= get<T>(eid);
+  touch<T>(eid);
+  return v;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+bool Registry::has(EntityId eid) const {
+  if constexpr (isTag<T>) {
+    return _engine && _engine->has(eid, EntityFeature<T>::id());
+  } else {
+    auto s= column<T>();
+    return X_NIL(s) && s->has(eid);
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+void Registry::erase(EntityId eid) {
+  auto s= column<T>();
+  if (X_NIL(s) && s->remove(eid)) {
+    if (_engine) { _engine->unbound(eid, EntityFeature<T>::id()); }
+  }
+}
+
+
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+//EOF
+
@@ -0,0 +1,103 @@
+/* Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
+
+#include "prefab.h"
+#include "profile.h"
+#include "view.h"
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+namespace czlab::ecs {
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+std::vector<Cid> Prefab::types() const {
+  std::vector<Cid> out;
+  for (auto& v : _values) { s__conj(out, v.cid); }
+  for (auto& m : _makers) { s__conj(out, m.cid); }
+  out.insert(out.end(), _tags.begin(), _tags.end());
+  return out;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::spawnBatch(const Prefab& p, size_t n, std::vector<EntityId>& out) {
+  if (n == 0) { return; }
+  auto cids= p.types();
+  for (auto cid : cids) { widen(cid); }
+
+  // free slots first, then one grow for the rest
+  auto b= out.size();
+  out.reserve(b + n);
+  while (out.size() - b < n && !_free.empty()) {
+    auto i= _free.back();
+    _free.pop_back();
+    _gens[i] |= GEN_LIVE;
+    s__conj(out, entHandle(i, _gens[i] & ~GEN_LIVE));
+  }
+  auto i0= (uint32_t)_gens.size();
+  auto more= n - (out.size() - b);
+  _gens.resize(i0 + more, 1 | GEN_LIVE);
+  _objs.resize(_gens.size());
+  _sigs.resize(_gens.size() * _sigWords, 0);
+  for (uint32_t i=i0; i < _gens.size(); ++i) {
+    s__conj(out, entHandle(i, 1));
+  }
+  ECS_PROF_COUNT(_prof, P_SPAWN, n);
+  auto eids= out.data() + b;
+
+  // every one of them has the same bits, and nothing else
+  std::vector<uint64_t> sig(_sigWords, 0);
+  for (auto cid : cids) { sig[cid/64] |= 1ULL << (cid%64); }
+  for (size_t k=0; k < n; ++k) {
+    std::copy_n(sig.data(), _sigWords, _sigs.data() + entIndex(eids[k])*_sigWords);
+  }
+
+  for (auto& v : p._values) {
+    v.column(_types)->fill(eids, v.bytes.data(), n);
+  }
+  for (auto& m : p._makers) {
+    for (size_t k=0; k < n; ++k) {
+      _types->put(m.cid, eids[k], EComponent(m.make()));
+    }
+  }
+
+  ECS_PROF_COUNT(_prof, P_BIND, n * cids.size());
+  for (auto cid : cids) {
+    stamp(changes(cid), eids, n);
+    if (watched(cid)) {
+      for (size_t k=0; k < n; ++k) {
+        s__conj(_pending, (Event{ cid, eids[k], true }));
+      }
+    }
+  }
+
+  // a view takes all of the batch or none of it
+  for (auto& [f, v] : _views) {
+    auto in= true;
+    for (auto cid : f.all) {
+      in= in && (size_t)cid/64 < _sigWords && (sig[cid/64] & (1ULL << (cid%64)));
+    }
+    for (auto cid : f.none) {
+      in= in && !((size_t)cid/64 < _sigWords && (sig[cid/64] & (1ULL << (cid%64))));
+    }
+    if (!in) { continue; }
+    v->_pos.reserve(v->_ids.size() + n);
+    for (size_t k=0; k < n; ++k) { v->add(eids[k]); }
+  }
+}
+
+
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+//EOF
+
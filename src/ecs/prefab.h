@@ -0,0 +1,129 @@
+#pragma once
+/* Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
+
+//////////////////////////////////////////////////////////////////////////////
+// Spawning many alike entities at once, e.g. a wave of enemies
+//
+//   Prefab grunt;
+//   grunt.add<Pos>(Pos{0,0}).add<Hp>(Hp{10}).tag<Enemy>();
+//   g->spawnBatch(grunt, 10000, ids);
+//
+// The slots, signatures and by value columns grow once for the
+// whole batch instead of once per entity and component.
+
+#include <functional>
+#include "pod.h"
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+namespace czlab::ecs {
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// What each entity of a batch starts out with.  Adding a type
+// twice keeps the last one.
+struct MSVC_DLL Prefab {
+
+  // a plain struct, every entity gets a copy of v
+  template<typename T>
+  Prefab& add(const T& v= T());
+
+  // a Component, every entity gets its own from make()
+  template<typename T>
+  Prefab& bind(std::function<T*()> make= [] { return new T(); });
+
+  template<typename T>
+  Prefab& tag();
+
+  // the component types, in no particular order
+  std::vector<Cid> types() const;
+
+  bool isEmpty() const {
+    return _values.empty() && _makers.empty() && _tags.empty();
+  }
+
+  Prefab() {}
+  ~Prefab() {}
+
+  friend struct Engine;
+  private:
+
+  struct Value {
+    Cid cid;
+    std::vector<char> bytes;
+    // the column of the type, made if missing
+    Column* (*column)(Registry*);
+  };
+
+  struct Maker {
+    Cid cid;
+    std::function<Component*()> make;
+  };
+
+  template<typename T>
+  static Column* reify(Registry* r) {
+    r->template reifyColumn<T>();
+    return r->column(EntityFeature<T>::id());
+  }
+
+  template<typename V>
+  static void drop(std::vector<V>& v, Cid cid) {
+    v.erase(std::remove_if(v.begin(), v.end(),
+                           [cid](const V& x) { return x.cid == cid; }), v.end());
+  }
+
+  std::vector<Value> _values;
+  std::vector<Maker> _makers;
+  std::vector<Cid> _tags;
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+Prefab& Prefab::add(const T& v) {
+  static_assert(!isTag<T>, "use tag() for empty types");
+  static_assert(isPod<T>, "use bind() for Component types");
+  auto cid= EntityFeature<T>::id();
+  drop(_values, cid);
+  Value x { cid, std::vector<char>(sizeof(T)), &reify<T> };
+  ::memcpy(x.bytes.data(), &v, sizeof(T));
+  s__conj(_values, std::move(x));
+  return *this;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+Prefab& Prefab::bind(std::function<T*()> make) {
+  static_assert(!isPod<T> && !isTag<T>, "bind() is for Component types");
+  auto cid= EntityFeature<T>::id();
+  drop(_makers, cid);
+  s__conj(_makers, (Maker{ cid, [make]() -> Component* { return make(); } }));
+  return *this;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+Prefab& Prefab::tag() {
+  static_assert(isTag<T>, "tags are empty structs");
+  auto cid= EntityFeature<T>::id();
+  if (std::find(_tags.begin(), _tags.end(), cid) == _tags.end()) {
+    s__conj(_tags, cid);
+  }
+  return *this;
+}
+
+
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+//EOF
+
@@ -0,0 +1,269 @@
+/* Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
+
+#include <fstream>
+#include <typeinfo>
+#if defined(__GNUC__)
+#include <cxxabi.h>
+#endif
+#include "profile.h"
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+namespace czlab::ecs {
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// small stable thread ids for the trace
+static std::atomic<int> _lastTid(0);
+static thread_local int _myTid= ++_lastTid;
+
+// every profiler gets a serial so threads can cache their buffer
+// per profiler without holding on to dangling pointers
+static std::atomic<llong> _lastSerial(0);
+
+struct BufSlot {
+  llong serial;
+  ProfBuf* buf;
+};
+
+static thread_local std::vector<BufSlot> _myBufs;
+
+static const char* _counterNames[P_COUNTERS] = {
+  "bind", "unbind", "spawn", "purge"
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+static stdstr sysName(const System* s) {
+  auto n= typeid(*s).name();
+#if defined(__GNUC__)
+  int rc=0;
+  if (auto d= abi::__cxa_demangle(n, NULL, NULL, &rc); X_NIL(d)) {
+    stdstr out(d);
+    ::free(d);
+    return out;
+  }
+#endif
+  return n;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// only its own thread writes it, the lock is taken by that thread
+// per sample and by merge() once a frame, so it is never contended
+// while systems run
+struct ProfBuf {
+  std::mutex lock;
+  std::map<const System*,Profiler::SysStat> systems;
+  std::map<std::vector<Cid>,Profiler::QueryStat> queries;
+  std::vector<Profiler::Event> events;
+
+  void clear() {
+    systems.clear();
+    queries.clear();
+    events.clear();
+  }
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+Profiler::Profiler(size_t frames, size_t events) {
+  _maxFrames= frames;
+  _maxEvents= events;
+  _serial= ++_lastSerial;
+  _epoch= Clock::now();
+  _start= _epoch;
+  for (auto& c : _counts) { c=0; }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+Profiler::~Profiler() {
+  for (auto b : _bufs) { delete b; }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+ProfBuf* Profiler::local() {
+  for (auto& s : _myBufs) {
+    if (s.serial == _serial) { return s.buf; }
+  }
+  auto b= new ProfBuf();
+  {
+    std::lock_guard<std::mutex> g(_lock);
+    s__conj(_bufs, b);
+  }
+  s__conj(_myBufs, (BufSlot{ _serial, b }));
+  return b;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Profiler::merge() {
+  for (auto b : _bufs) {
+    std::lock_guard<std::mutex> g(b->lock);
+    for (auto& [s,x] : b->systems) {
+      auto& st= _systems[s];
+      if (st.calls == 0) { st.name= sysName(s); }
+      st.calls += x.calls;
+      st.total += x.total;
+      st.worst= std::max(st.worst, x.worst);
+      for (auto i=0; i < BUCKETS; ++i) { st.hist[i] += x.hist[i]; }
+    }
+    for (auto& [sig,x] : b->queries) {
+      auto& q= _queries[sig];
+      q.calls += x.calls;
+      q.hits += x.hits;
+    }
+    auto n= std::min(b->events.size(), _maxEvents - _events.size());
+    _events.insert(_events.end(), b->events.begin(), b->events.begin() + n);
+    b->clear();
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Profiler::reset() {
+  std::lock_guard<std::mutex> g(_lock);
+  for (auto b : _bufs) {
+    std::lock_guard<std::mutex> g2(b->lock);
+    b->clear();
+  }
+  for (auto& c : _counts) { c=0; }
+  _systems.clear();
+  _queries.clear();
+  _frames.clear();
+  _events.clear();
+  _epoch= Clock::now();
+  _frame=0;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Profiler::query(const std::vector<Cid>& sig, size_t hits) {
+  auto b= local();
+  std::lock_guard<std::mutex> g(b->lock);
+  auto& q= b->queries[sig];
+  ++q.calls;
+  q.hits += hits;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Profiler::system(const System* s, Clock::time_point t0, Clock::time_point t1) {
+  auto dur= std::chrono::duration<double,std::micro>(t1 - t0).count();
+  int k=0;
+  while (k < BUCKETS-1 && dur >= (double)(1LL << k)) { ++k; }
+
+  auto b= local();
+  std::lock_guard<std::mutex> g(b->lock);
+  auto& st= b->systems[s];
+  ++st.calls;
+  st.total += dur;
+  st.worst= std::max(st.worst, dur);
+  ++st.hist[k];
+  // merge() keeps at most _maxEvents overall
+  if (b->events.size() < _maxEvents) {
+    s__conj(b->events, (Event{ s, _myTid, micros(t0), dur }));
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Profiler::begin() {
+  // whatever changed between frames counts toward the next one
+  _start= Clock::now();
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Profiler::end() {
+  FrameStat f;
+  f.ts= micros(_start);
+  f.dur= std::chrono::duration<double,std::micro>(Clock::now() - _start).count();
+  for (auto i=0; i < P_COUNTERS; ++i) {
+    f.counts[i]= _counts[i].exchange(0);
+  }
+  std::lock_guard<std::mutex> g(_lock);
+  merge();
+  f.frame= ++_frame;
+  s__conj(_frames, f);
+  if (_frames.size() > _maxFrames) { _frames.pop_front(); }
+  if (_events.size() < _maxEvents) {
+    s__conj(_events, (Event{ NULL, _myTid, f.ts, f.dur }));
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+j::json Profiler::report() const {
+  std::lock_guard<std::mutex> g(_lock);
+  auto out= j::json::object();
+  auto ss= j::json::array();
+  for (auto& [s,st] : _systems) {
+    j::json h= j::json::array();
+    for (auto i=0; i < BUCKETS; ++i) { h.push_back(st.hist[i]); }
+    ss.push_back({
+      {"name", st.name},
+      {"calls", st.calls},
+      {"totalUs", st.total},
+      {"meanUs", st.calls > 0 ? st.total / st.calls : 0},
+      {"worstUs", st.worst},
+      {"histogram", h}
+    });
+  }
+  auto qs= j::json::array();
+  for (auto& [sig,q] : _queries) {
+    qs.push_back({{"sig", sig}, {"calls", q.calls}, {"hits", q.hits}});
+  }
+  auto fs= j::json::array();
+  for (auto& f : _frames) {
+    j::json c= {{"frame", f.frame}, {"us", f.dur}};
+    for (auto i=0; i < P_COUNTERS; ++i) { c[_counterNames[i]]= f.counts[i]; }
+    fs.push_back(c);
+  }
+  out["systems"]= ss;
+  out["queries"]= qs;
+  out["frames"]= fs;
+  return out;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+j::json Profiler::trace() const {
+  std::lock_guard<std::mutex> g(_lock);
+  auto evs= j::json::array();
+  for (auto& e : _events) {
+    stdstr n= "frame";
+    if (X_NIL(e.sys)) {
+      auto i= _systems.find(e.sys);
+      n= i != _systems.end() ? i->second.name : "system";
+    }
+    evs.push_back({
+      {"name", n}, {"cat", X_NIL(e.sys) ? "system" : "engine"},
+      {"ph", "X"}, {"ts", e.ts}, {"dur", e.dur},
+      {"pid", 1}, {"tid", e.tid}
+    });
+  }
+  // per frame structural changes as counter tracks
+  for (auto& f : _frames) {
+    j::json args= j::json::object();
+    for (auto i=0; i < P_COUNTERS; ++i) { args[_counterNames[i]]= f.counts[i]; }
+    evs.push_back({
+      {"name", "changes"}, {"ph", "C"}, {"ts", f.ts}, {"pid", 1}, {"args", args}
+    });
+  }
+  return {{"traceEvents", evs}, {"displayTimeUnit", "ms"}};
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+bool Profiler::saveTrace(const stdstr& file) const {
+  std::ofstream out(file);
+  if (!out) { return false; }
+  out << trace().dump();
+  return out.good();
+}
+
+
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+//EOF
+
@@ -0,0 +1,172 @@
+#pragma once
+/* Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
+
+//////////////////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include "types.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// Build everything with -DECS_PROFILE=1 to turn on the profiler,
+// otherwise the hooks below compile to nothing.
+#if !defined(ECS_PROFILE)
+  #define ECS_PROFILE 0
+#endif
+
+#if ECS_PROFILE
+  #define ECS_PROF_SYSTEM(p,s) Profiler::Scope __prof_scope(p,s)
+  #define ECS_PROF_FRAME(p) Profiler::Frame __prof_frame(p)
+  #define ECS_PROF_COUNT(p,what,n) do{ if (p) { (p)->count(what,n); } }while(0)
+  #define ECS_PROF_QUERY(p,sig,n) do{ if (p) { (p)->query(sig,n); } }while(0)
+#else
+  #define ECS_PROF_SYSTEM(p,s) NO_OP
+  #define ECS_PROF_FRAME(p) NO_OP
+  #define ECS_PROF_COUNT(p,what,n) NO_OP
+  #define ECS_PROF_QUERY(p,sig,n) NO_OP
+#endif
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+namespace czlab::ecs {
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// structural changes counted per frame
+enum ProfCounter {
+  P_BIND=0,
+  P_UNBIND,
+  P_SPAWN,
+  P_PURGE,
+  P_COUNTERS
+};
+
+// the samples of one thread between two frame ends, see profile.cpp
+struct ProfBuf;
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// Collects system timings, query hits and structural change counts
+// of an engine, see Engine::profiler().  Safe to feed from systems
+// running in parallel, each thread records into its own buffer and
+// the buffers are merged at the end of every frame, so report()
+// and trace() show everything up to the last frame.
+struct MSVC_DLL Profiler {
+
+  typedef std::chrono::steady_clock Clock;
+
+  // bucket k holds updates which took [2^(k-1), 2^k) micro-seconds
+  static constexpr int BUCKETS= 24;
+
+  struct SysStat {
+    stdstr name;
+    llong calls=0;
+    double total=0;
+    double worst=0;
+    llong hist[BUCKETS]={0};
+  };
+
+  struct QueryStat {
+    llong calls=0;
+    llong hits=0;
+  };
+
+  struct FrameStat {
+    llong frame;
+    double ts;
+    double dur;
+    llong counts[P_COUNTERS];
+  };
+
+  // times a system update
+  struct Scope {
+    Scope(Profiler* p, const System* s) : _p(p), _s(s) {
+      if (_p) { _t0= Clock::now(); }
+    }
+    ~Scope() { if (_p) { _p->system(_s, _t0, Clock::now()); } }
+    Profiler* _p;
+    const System* _s;
+    Clock::time_point _t0;
+  };
+
+  // times a whole engine update
+  struct Frame {
+    Frame(Profiler* p) : _p(p) { if (_p) { _p->begin(); } }
+    ~Frame() { if (_p) { _p->end(); } }
+    Profiler* _p;
+  };
+
+  void count(ProfCounter c, llong n) { _counts[c] += n; }
+  void query(const std::vector<Cid>&, size_t hits);
+  void system(const System*, Clock::time_point, Clock::time_point);
+  void begin();
+  void end();
+
+  // per system, per query and per frame numbers
+  j::json report() const;
+
+  // the recorded events in Chrome's trace event format,
+  // load it in chrome://tracing or Perfetto
+  j::json trace() const;
+  bool saveTrace(const stdstr& file) const;
+
+  // forget everything recorded so far
+  void reset();
+
+  // the last this many frames are kept, and at most
+  // this many trace events
+  Profiler(size_t frames= 600, size_t events= 1 << 20);
+  ~Profiler();
+
+  struct Event {
+    const System* sys;
+    int tid;
+    double ts;
+    double dur;
+  };
+
+  private:
+
+  // this thread's buffer, made on first use
+  ProfBuf* local();
+  // fold every buffer into the totals, under _lock
+  void merge();
+
+  double micros(Clock::time_point t) const {
+    return std::chrono::duration<double,std::micro>(t - _epoch).count();
+  }
+
+  std::atomic<llong> _counts[P_COUNTERS];
+  std::map<const System*,SysStat> _systems;
+  std::map<std::vector<Cid>,QueryStat> _queries;
+  std::deque<FrameStat> _frames;
+  std::vector<Event> _events;
+  std::vector<ProfBuf*> _bufs;
+  Clock::time_point _epoch;
+  Clock::time_point _start;
+  size_t _maxFrames;
+  size_t _maxEvents;
+  llong _frame=0;
+  llong _serial;
+  mutable std::mutex _lock;
+
+  Profiler(const Profiler&) = delete;
+  Profiler& operator=(const Profiler&) = delete;
+};
+
+
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+//EOF
+
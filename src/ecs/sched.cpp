@@ -0,0 +1,221 @@
+/* Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
+
+#include "profile.h"
+#include "sched.h"
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+namespace czlab::ecs {
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// which pool and lane the current thread works for
+static thread_local Jobs* _myPool=NULL;
+static thread_local int _myLane= -1;
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+Jobs::Jobs(int workers) {
+  _next=0;
+  _queued=0;
+  for (auto i=0; i < workers; ++i) {
+    s__conj(_lanes, std::make_unique<Lane>());
+  }
+  for (auto i=0; i < workers; ++i) {
+    s__conj(_threads, std::thread([this,i]() { loop(i); }));
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+Jobs::~Jobs() {
+  {
+    std::lock_guard<std::mutex> g(_mutex);
+    _quit=true;
+  }
+  _cv.notify_all();
+  for (auto& t : _threads) { t.join(); }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Jobs::submit(std::function<void()> f) {
+  // workers keep their own tasks local, outsiders spread them out
+  auto n= (_myPool == this) ? _myLane : (int)(_next++ % _lanes.size());
+  {
+    auto& L= *_lanes[n];
+    std::lock_guard<std::mutex> g(L.mutex);
+    s__conj(L.tasks, std::move(f));
+  }
+  ++_queued;
+  {
+    std::lock_guard<std::mutex> g(_mutex);
+  }
+  _cv.notify_one();
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+bool Jobs::pop(int lane, Task& out) {
+  auto z= (int)_lanes.size();
+  if (lane >= 0) {
+    auto& L= *_lanes[lane];
+    std::lock_guard<std::mutex> g(L.mutex);
+    if (!L.tasks.empty()) {
+      out= std::move(L.tasks.back());
+      L.tasks.pop_back();
+      --_queued;
+      return true;
+    }
+  }
+  // steal from the other end of someone else's deque
+  for (auto k=1; k <= z; ++k) {
+    auto n= (lane + k + z) % z;
+    if (n == lane) { continue; }
+    auto& L= *_lanes[n];
+    std::lock_guard<std::mutex> g(L.mutex);
+    if (!L.tasks.empty()) {
+      out= std::move(L.tasks.front());
+      L.tasks.pop_front();
+      --_queued;
+      return true;
+    }
+  }
+  return false;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Jobs::loop(int lane) {
+  _myPool=this;
+  _myLane=lane;
+  Task f;
+  while (true) {
+    if (pop(lane, f)) {
+      f();
+      f= NULL;
+      continue;
+    }
+    std::unique_lock<std::mutex> g(_mutex);
+    _cv.wait(g, [this]() { return _quit || _queued > 0; });
+    if (_quit && _queued == 0) { return; }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Jobs::parallelFor(size_t n, size_t grain,
+                       const std::function<void(size_t,size_t)>& f) {
+  if (n == 0) { return; }
+  if (grain == 0) { grain=1; }
+  auto chunks= (n + grain - 1) / grain;
+  if (chunks == 1 || _lanes.empty()) {
+    f(0, n);
+    return;
+  }
+
+  std::atomic<size_t> left(chunks);
+  for (size_t c=1; c < chunks; ++c) {
+    submit([&f,&left,c,grain,n]() {
+      f(c*grain, std::min(n, (c+1)*grain));
+      --left;
+    });
+  }
+  // do the first chunk here, then help with the rest
+  f(0, std::min(n, grain));
+  --left;
+
+  auto lane= (_myPool == this) ? _myLane : -1;
+  Task t;
+  while (left > 0) {
+    if (pop(lane, t)) {
+      t();
+      t= NULL;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+Scheduler::Scheduler(Engine* e, int workers) : _jobs(workers) {
+  _engine=e;
+  _halt=false;
+  _left=0;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Scheduler::build() {
+  auto& ss= _engine->_systems;
+  auto n= (int)ss.size();
+
+  _nodes.clear();
+  _roots.clear();
+  _succ.assign(n, std::vector<int>());
+  _deps.assign(n, 0);
+  for (auto& s : ss) { s__conj(_nodes, s.ptr()); }
+
+  // systems are already sorted by priority, so
+  // edges only ever point from i to a later j
+  for (auto j=0; j < n; ++j) {
+    for (auto i=0; i < j; ++i) {
+      if (_nodes[i]->conflicts(_nodes[j])) {
+        s__conj(_succ[i], j);
+        ++_deps[j];
+      }
+    }
+    if (_deps[j] == 0) { s__conj(_roots, j); }
+  }
+
+  _pending.reset(new std::atomic<int>[n]);
+  _dirty=false;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Scheduler::exec(int node, float time) {
+  auto s= _nodes[node];
+  // once a system says stop, whatever has not started is skipped
+  if (!_halt && s->isActive()) {
+    ECS_PROF_SYSTEM(_engine->_prof, s);
+    if (! s->run(time, _engine->_maxSteps)) { _halt=true; }
+  }
+  for (auto k : _succ[node]) {
+    if (--_pending[k] == 0) {
+      _jobs.submit([this,k,time]() { exec(k,time); });
+    }
+  }
+  // under the lock, else run() may see 0 on a spurious wakeup
+  // and return, and the engine free us, before we notify
+  std::lock_guard<std::mutex> g(_mutex);
+  if (--_left == 0) { _done.notify_all(); }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Scheduler::run(float time) {
+  if (_dirty) { build(); }
+  if (_nodes.empty()) { return; }
+
+  for (size_t i=0; i < _nodes.size(); ++i) {
+    _pending[i]= _deps[i];
+  }
+  _left= (int)_nodes.size();
+  _halt=false;
+
+  for (auto r : _roots) {
+    _jobs.submit([this,r,time]() { exec(r,time); });
+  }
+
+  std::unique_lock<std::mutex> g(_mutex);
+  _done.wait(g, [this]() { return _left == 0; });
+}
+
+
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+//EOF
+
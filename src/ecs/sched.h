@@ -0,0 +1,114 @@
+#pragma once
+/* Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
+
+//////////////////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "types.h"
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+namespace czlab::ecs {
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// A fixed set of worker threads, each with its own task deque.
+// Workers pop their own newest task first and steal the oldest
+// from the others when they run dry.
+struct MSVC_DLL Jobs {
+
+  void submit(std::function<void()>);
+  int size() const { return (int)_threads.size(); }
+
+  // call f(begin,end) over [0,n) in chunks of grain items, the
+  // calling thread helps out until every chunk is done
+  void parallelFor(size_t n, size_t grain,
+                   const std::function<void(size_t,size_t)>& f);
+
+  explicit Jobs(int workers);
+  ~Jobs();
+
+  private:
+
+  typedef std::function<void()> Task;
+
+  struct Lane {
+    std::deque<Task> tasks;
+    std::mutex mutex;
+  };
+
+  bool pop(int lane, Task&);
+  void loop(int lane);
+
+  std::vector<std::unique_ptr<Lane>> _lanes;
+  std::vector<std::thread> _threads;
+  std::atomic<unsigned> _next;
+  std::atomic<int> _queued;
+  std::condition_variable _cv;
+  std::mutex _mutex;
+  bool _quit=false;
+
+  Jobs(const Jobs&) = delete;
+  Jobs& operator=(const Jobs&) = delete;
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// Runs the engine's systems as a dependency graph.  A system
+// depends on every higher priority system it conflicts with,
+// anything else is free to run alongside it.
+struct MSVC_DLL Scheduler {
+
+  Jobs* jobs() { return &_jobs; }
+
+  // rebuild the graph before the next run
+  void reset() { _dirty=true; }
+  void run(float time);
+
+  Scheduler(Engine*, int workers);
+  ~Scheduler() {}
+
+  private:
+
+  void exec(int node, float time);
+  void build();
+
+  std::vector<std::vector<int>> _succ;
+  std::vector<System*> _nodes;
+  std::vector<int> _roots;
+  std::vector<int> _deps;
+
+  std::unique_ptr<std::atomic<int>[]> _pending;
+  std::atomic<bool> _halt;
+  std::atomic<int> _left;
+  std::condition_variable _done;
+  std::mutex _mutex;
+
+  Engine* _engine;
+  bool _dirty=true;
+  Jobs _jobs;
+
+  Scheduler(const Scheduler&) = delete;
+  Scheduler& operator=(const Scheduler&) = delete;
+};
+
+
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+//EOF
+
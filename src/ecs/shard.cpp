@@ -0,0 +1,79 @@
+/* Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
+
+#include "shard.h"
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+namespace czlab::ecs {
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+bool Engine::emigrate(EntityId eid, Parcel& p) {
+  if (!isAlive(eid)) { return false; }
+  p.codecs.clear();
+  p.bytes.clear();
+  auto s= _sigs.data() + entIndex(eid) * _sigWords;
+  for (auto c : Codecs::all()) {
+    auto cid= c->cid();
+    if ((size_t)cid/64 >= _sigWords ||
+        (s[cid/64] & (1ULL << (cid%64))) == 0) { continue; }
+    auto n= p.bytes.size();
+    if (c->isTag()) {
+      // no bytes, the codec says it all
+    } else if (c->byValue()) {
+      auto col= _types->column(cid);
+      auto v= X_NIL(col) ? col->at(eid) : NULL;
+      if (E_NIL(v)) { continue; }
+      p.bytes.resize(n + c->size());
+      ::memcpy(p.bytes.data() + n, v, c->size());
+    } else {
+      auto v= _types->lookup(cid, eid);
+      if (E_NIL(v)) { continue; }
+      p.bytes.resize(n + c->size());
+      c->save(&v, 1, p.bytes.data() + n);
+    }
+    s__conj(p.codecs, c);
+  }
+  purgeEnt(eid);
+  return true;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+EntityId Engine::immigrate(const Parcel& p) {
+  size_t total=0;
+  for (auto c : p.codecs) { total += c->size(); }
+  // not made by emigrate(), no handle is ever 0
+  if (total != p.bytes.size()) { return 0; }
+  auto eid= spawn();
+  auto in= p.bytes.data();
+  for (auto c : p.codecs) {
+    auto cid= c->cid();
+    if (c->isTag()) {
+      bound(eid, cid);
+    } else if (c->byValue()) {
+      c->column(_types)->load(&eid, in, 1);
+      bound(eid, cid);
+    } else {
+      _types->attach(cid, eid, EComponent(c->load(in)));
+    }
+    in += c->size();
+  }
+  return eid;
+}
+
+
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+//EOF
+
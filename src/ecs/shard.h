@@ -0,0 +1,147 @@
+#pragma once
+/* Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
+
+//////////////////////////////////////////////////////////////////////////////
+// Running many worlds in one process, say a zone per core.  Each
+// Engine has its own entity ids and may live on its own thread,
+// only component type ids and codecs are shared.  Worlds talk by
+// posting to each other's mailboxes.
+
+#include <atomic>
+#include <memory>
+#include "snapshot.h"
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+namespace czlab::ecs {
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// An entity on its way between engines, see Engine::emigrate().
+// Only components with a codec travel, see snapshotable<T>()
+struct MSVC_DLL Parcel {
+  // one per record, in order
+  std::vector<const Codec*> codecs;
+  // the records back to back, codec->size() bytes each
+  std::vector<char> bytes;
+  // free for the game, e.g. which door it came through
+  llong tag=0;
+
+  void clear() { codecs.clear(); bytes.clear(); tag=0; }
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// A bounded queue any number of threads may push to and pop
+// from without locks.  Each slot carries a sequence number telling
+// whose turn it is, so a push or pop is one compare and swap on
+// the shared counter.  Nothing is allocated after construction.
+template<typename T>
+struct Mailbox {
+
+  // false if full, v is left alone then
+  bool push(T&& v);
+  bool push(const T& v) { T c(v); return push(std::move(c)); }
+
+  // false if empty
+  bool pop(T&);
+
+  size_t capacity() const { return _mask+1; }
+
+  // rounded up to a power of 2
+  explicit Mailbox(size_t capacity);
+  ~Mailbox() {}
+
+  private:
+
+  struct Cell {
+    std::atomic<size_t> seq;
+    T data;
+  };
+
+  std::unique_ptr<Cell[]> _cells;
+  size_t _mask;
+  // apart, so pushers and poppers do not share a cache line
+  alignas(64) std::atomic<size_t> _tail;
+  alignas(64) std::atomic<size_t> _head;
+
+  Mailbox(const Mailbox&) = delete;
+  Mailbox& operator=(const Mailbox&) = delete;
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+Mailbox<T>::Mailbox(size_t capacity) {
+  size_t n=2;
+  while (n < capacity) { n <<= 1; }
+  _cells.reset(new Cell[n]);
+  for (size_t i=0; i < n; ++i) {
+    _cells[i].seq.store(i, std::memory_order_relaxed);
+  }
+  _mask= n-1;
+  _tail.store(0, std::memory_order_relaxed);
+  _head.store(0, std::memory_order_relaxed);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+bool Mailbox<T>::push(T&& v) {
+  auto pos= _tail.load(std::memory_order_relaxed);
+  Cell* c;
+  for (;;) {
+    c= &_cells[pos & _mask];
+    auto seq= c->seq.load(std::memory_order_acquire);
+    auto dif= (intptr_t)seq - (intptr_t)pos;
+    if (dif == 0) {
+      // the slot is free, claim it
+      if (_tail.compare_exchange_weak(pos, pos+1, std::memory_order_relaxed)) { break; }
+    } else if (dif < 0) {
+      // a lap behind, still holds an unread message
+      return false;
+    } else {
+      pos= _tail.load(std::memory_order_relaxed);
+    }
+  }
+  c->data= std::move(v);
+  c->seq.store(pos+1, std::memory_order_release);
+  return true;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+bool Mailbox<T>::pop(T& out) {
+  auto pos= _head.load(std::memory_order_relaxed);
+  Cell* c;
+  for (;;) {
+    c= &_cells[pos & _mask];
+    auto seq= c->seq.load(std::memory_order_acquire);
+    auto dif= (intptr_t)seq - (intptr_t)(pos+1);
+    if (dif == 0) {
+      if (_head.compare_exchange_weak(pos, pos+1, std::memory_order_relaxed)) { break; }
+    } else if (dif < 0) {
+      return false;
+    } else {
+      pos= _head.load(std::memory_order_relaxed);
+    }
+  }
+  out= std::move(c->data);
+  // free for the pusher one lap on
+  c->seq.store(pos + _mask + 1, std::memory_order_release);
+  return true;
+}
+
+
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+//EOF
+
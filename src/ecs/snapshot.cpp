@@ -0,0 +1,476 @@
+/* Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "snapshot.h"
+#include "view.h"
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+namespace czlab::ecs {
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// Layout, every section starts on an 8 byte boundary:
+//   Header
+//   uint32 gen[slots], GEN_LIVE set on the live ones
+//   uint64 sig[slots * sigWords]
+//   uint32 free[nfree]
+//   per column: ColHeader, name, uint32 index[count],
+//               count records of size bytes
+static const char MAGIC[8]= { 'E','C','S','S','N','A','P','1' };
+// 3: no alive array, it is the top bit of gen
+// 2: columns named by typeName(), 1 used typeid names
+static const uint32_t VERSION= 3;
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t sigWords;
+  uint32_t slots;
+  uint32_t nfree;
+  uint32_t columns;
+  uint32_t pad;
+};
+
+struct ColHeader {
+  uint32_t nameLen;
+  uint32_t cid;
+  uint32_t size;
+  uint32_t count;
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+static size_t pad8(size_t n) { return (n + 7) & ~(size_t)7; }
+
+// step over n written bytes, zeroing the padding so the same
+// world always gives the same bytes
+static char* skip(char* p, size_t n) {
+  ::memset(p + n, 0, pad8(n) - n);
+  return p + pad8(n);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// bounds checked walk over a blob
+struct Reader {
+  const char* base;
+  size_t len;
+  size_t pos;
+  // the next n bytes, or NULL if the blob is too short
+  const char* take(size_t n) {
+    if (pos > len || n > len - pos) { return NULL; }
+    auto p= base + pos;
+    pos= pad8(pos + n);
+    return p;
+  }
+  // the next n records of size bytes, the sizes come from the
+  // blob so the product is checked before it is made
+  const char* take(size_t n, size_t size) {
+    if (size > 0 && n > len / size) { return NULL; }
+    return take(n * size);
+  }
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+struct CodecList {
+  ~CodecList() { for (auto c : all) { delete c; } }
+  std::vector<Codec*> all;
+};
+
+static std::vector<Codec*>& codecs() {
+  static CodecList _list;
+  return _list.all;
+}
+
+static std::mutex _codecLock;
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Codecs::add(Codec* c) {
+  std::lock_guard<std::mutex> g(_codecLock);
+  for (auto x : codecs()) {
+    // first one wins
+    if (x->cid() == c->cid()) { delete c; return; }
+  }
+  s__conj(codecs(), c);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+Codec* Codecs::find(const stdstr& name) {
+  std::lock_guard<std::mutex> g(_codecLock);
+  for (auto c : codecs()) {
+    if (c->name() == name) { return c; }
+  }
+  return NULL;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+Codec* Codecs::find(Cid cid) {
+  std::lock_guard<std::mutex> g(_codecLock);
+  for (auto c : codecs()) {
+    if (c->cid() == cid) { return c; }
+  }
+  return NULL;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+std::vector<Codec*> Codecs::all() {
+  std::lock_guard<std::mutex> g(_codecLock);
+  return codecs();
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Engine::snapshot(std::vector<char>& out) const {
+  struct Col {
+    Codec* codec;
+    std::vector<EntityId> eids;
+    std::vector<Component*> cs;
+    Column* values;
+  };
+  std::vector<Col> cols;
+  auto n= _gens.size();
+
+  size_t total= pad8(sizeof(Header)) +
+                pad8(n * sizeof(uint32_t)) +
+                n * _sigWords * sizeof(uint64_t) +
+                pad8(_free.size() * sizeof(uint32_t));
+  for (auto c : Codecs::all()) {
+    Col col { c, {}, {}, NULL };
+    size_t cnt;
+    // tags are in the signatures, by value columns are
+    // copied straight out
+    if (c->isTag()) {
+      query(std::vector<Cid>{ c->cid() }, col.eids);
+      cnt= col.eids.size();
+    } else if (c->byValue()) {
+      col.values= _types->column(c->cid());
+      cnt= X_NIL(col.values) ? col.values->size() : 0;
+    } else {
+      _types->gather(c->cid(), col.eids, col.cs);
+      cnt= col.eids.size();
+    }
+    if (cnt == 0) { continue; }
+    total += sizeof(ColHeader) +
+             pad8(c->name().size()) +
+             pad8(cnt * sizeof(uint32_t)) +
+             pad8(cnt * c->size());
+    s__conj(cols, std::move(col));
+  }
+
+  out.resize(total);
+  auto p= out.data();
+
+  Header h;
+  ::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+  h.version= VERSION;
+  h.sigWords= (uint32_t) _sigWords;
+  h.slots= (uint32_t) n;
+  h.nfree= (uint32_t) _free.size();
+  h.columns= (uint32_t) cols.size();
+  h.pad= 0;
+  ::memcpy(p, &h, sizeof(h));
+  p += sizeof(h);
+
+  // an empty vector's data() may be NULL, not fit for memcpy
+  if (n > 0) {
+    ::memcpy(p, _gens.data(), n * sizeof(uint32_t));
+    p= skip(p, n * sizeof(uint32_t));
+    ::memcpy(p, _sigs.data(), n * _sigWords * sizeof(uint64_t));
+  }
+  p += n * _sigWords * sizeof(uint64_t);
+  if (!_free.empty()) { ::memcpy(p, _free.data(), _free.size() * sizeof(uint32_t)); }
+  p= skip(p, _free.size() * sizeof(uint32_t));
+
+  for (auto& col : cols) {
+    auto c= col.codec;
+    auto& eids= X_NIL(col.values) ? col.values->ids() : col.eids;
+    auto cnt= eids.size();
+    ColHeader ch { (uint32_t) c->name().size(), (uint32_t) c->cid(),
+                   (uint32_t) c->size(), (uint32_t) cnt };
+    ::memcpy(p, &ch, sizeof(ch));
+    p += sizeof(ch);
+    ::memcpy(p, c->name().data(), c->name().size());
+    p= skip(p, c->name().size());
+    auto idx= (uint32_t*) p;
+    for (size_t i=0; i < cnt; ++i) { idx[i]= entIndex(eids[i]); }
+    p= skip(p, cnt * sizeof(uint32_t));
+    if (X_NIL(col.values)) {
+      ::memcpy(p, col.values->data(), cnt * c->size());
+    } else {
+      c->save(col.cs.data(), cnt, p);
+    }
+    p= skip(p, cnt * c->size());
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+bool SnapshotImage::parse(const char* blob, size_t len) {
+  Reader r { blob, len, 0 };
+  columns.clear();
+
+  auto h= (const Header*) r.take(sizeof(Header));
+  if (E_NIL(h) ||
+      ::memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      h->version != VERSION ||
+      h->sigWords == 0 ||
+      h->sigWords > len / sizeof(uint64_t) ||
+      h->nfree > h->slots) { return false; }
+
+  slots= h->slots;
+  sigWords= h->sigWords;
+  nfree= h->nfree;
+  gens= (const uint32_t*) r.take(slots, sizeof(uint32_t));
+  sigs= (const uint64_t*) r.take(slots, sigWords * sizeof(uint64_t));
+  frees= (const uint32_t*) r.take(nfree, sizeof(uint32_t));
+  if (E_NIL(gens) || E_NIL(sigs) || E_NIL(frees)) {
+    return false;
+  }
+  // every slot is either alive or free, exactly once, else
+  // spawn() could hand out a slot twice or never again
+  std::vector<uint8_t> seen(slots, 0);
+  size_t live=0;
+  for (size_t i=0; i < slots; ++i) {
+    if (gens[i] & GEN_LIVE) { seen[i]=1; ++live; }
+  }
+  for (size_t i=0; i < nfree; ++i) {
+    if (frees[i] >= slots || seen[frees[i]]) { return false; }
+    seen[frees[i]]=1;
+  }
+  if (live + nfree != slots) { return false; }
+
+  // which column last had each slot, a slot twice in one column
+  // would break the index load() builds
+  std::vector<uint32_t> mark(h->columns > 0 ? slots : 0, 0);
+  for (uint32_t k=0; k < h->columns; ++k) {
+    auto ch= (const ColHeader*) r.take(sizeof(ColHeader));
+    if (E_NIL(ch)) { return false; }
+    auto name= r.take(ch->nameLen);
+    auto idx= (const uint32_t*) r.take(ch->count, sizeof(uint32_t));
+    auto data= r.take(ch->count, ch->size);
+    if (E_NIL(name) || E_NIL(idx) || E_NIL(data)) { return false; }
+    for (uint32_t i=0; i < ch->count; ++i) {
+      auto x= idx[i];
+      if (x >= slots || !(gens[x] & GEN_LIVE) || mark[x] == k+1) { return false; }
+      mark[x]= k+1;
+    }
+    s__conj(columns, (Column{ stdstr(name, ch->nameLen), (Cid) ch->cid,
+                              ch->size, ch->count, idx, data }));
+  }
+  return true;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+const SnapshotImage::Column* SnapshotImage::column(const stdstr& name) const {
+  for (auto& c : columns) {
+    if (c.name == name) { return &c; }
+  }
+  return NULL;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+bool Engine::restore(const char* blob, size_t len) {
+  SnapshotImage img;
+  return img.parse(blob, len) && restore(img);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+bool Engine::restore(const SnapshotImage& img) {
+  return restore(img, NULL);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+bool Engine::restore(MappedSnapshot* m) {
+  if (X_NIL(m) && m->isOpen() && restore(m->image(), m)) {
+    return true;
+  }
+  // a failed restore leaves the old world, and what it borrows
+  if (m != _mapped) { DEL_PTR(m); }
+  return false;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+bool Engine::restore(const SnapshotImage& img, MappedSnapshot* keep) {
+  struct Col {
+    Codec* codec;
+    const SnapshotImage::Column* src;
+  };
+  size_t n= img.slots;
+  size_t w= img.sigWords;
+  auto gens= img.gens;
+  auto sigs= img.sigs;
+
+  // check everything before touching the world
+  if (E_NIL(gens) || E_NIL(sigs) || E_NIL(img.frees)) {
+    return false;
+  }
+  std::vector<Col> cols;
+  auto same= w <= _sigWords;
+  for (auto& src : img.columns) {
+    auto c= Codecs::find(src.name);
+    // types not known here are skipped
+    if (E_NIL(c)) { same=false; continue; }
+    if (c->size() != src.size) { return false; }
+    if (c->cid() != src.cid || (size_t)src.cid/64 >= w) { same=false; }
+    s__conj(cols, (Col{ c, &src }));
+  }
+
+  // out with the old world
+  for (auto i=_views.begin(),e=_views.end();i != e;++i) {
+    i->second->clear();
+  }
+  _types->clear();
+  _types->clearPods();
+  forget();
+  // the old world's events make no sense any more
+  _pending.clear();
+  for (auto& o : _objs) {
+    if (o.isSome()) {
+      o->die();
+      s__conj(_garbo, o);
+      o= EEntity();
+    }
+  }
+  _objs.resize(n);
+  _gens.assign(gens, gens + n);
+  _free.assign(img.frees, img.frees + img.nfree);
+
+  // signatures go over as is when the type ids line up,
+  // minus the bits of components that did not come along
+  if (same) {
+    std::vector<uint64_t> keep(_sigWords, 0);
+    for (auto& col : cols) {
+      keep[col.codec->cid()/64] |= 1ULL << (col.codec->cid()%64);
+    }
+    _sigs.resize(n * _sigWords);
+    auto d= _sigs.data();
+    if (w == 1 && _sigWords == 1) {
+      // the usual case, one straight pass
+      for (size_t i=0; i < n; ++i) { d[i]= sigs[i] & keep[0]; }
+    } else {
+      for (size_t i=0; i < n; ++i, d += _sigWords, sigs += w) {
+        std::fill(d + w, d + _sigWords, 0);
+        for (size_t k=0; k < w; ++k) { d[k]= sigs[k] & keep[k]; }
+      }
+    }
+  } else {
+    _sigs.assign(n * _sigWords, 0);
+  }
+
+  for (auto& col : cols) {
+    auto c= col.codec;
+    auto cid= c->cid();
+    widen(cid);
+    auto src= col.src;
+    // all of it is new to whoever asks changed()
+    changes(cid)->all= _tick;
+    std::vector<EntityId> eids(src->count);
+    for (size_t i=0; i < src->count; ++i) {
+      auto x= src->index[i];
+      eids[i]= entHandle(x, gens[x] & ~GEN_LIVE);
+      if (!same) {
+        _sigs[x*_sigWords + cid/64] |= 1ULL << (cid%64);
+      }
+    }
+    if (c->isTag()) {
+      // the bits are all there is
+    } else if (c->byValue()) {
+      // straight into the packed array, or used where it is
+      if (X_NIL(keep)) {
+        c->column(_types)->borrow(eids, src->data);
+      } else {
+        c->column(_types)->load(eids.data(), src->data, src->count);
+      }
+    } else {
+      for (size_t i=0; i < src->count; ++i) {
+        _types->put(cid, eids[i], EComponent(c->load(src->data + i * c->size())));
+      }
+    }
+  }
+
+  for (auto i=_views.begin(),e=_views.end();i != e;++i) {
+    i->second->refill();
+  }
+  // nothing points into the old mapping now, img may have
+  // been in it so not before
+  if (_mapped != keep) {
+    DEL_PTR(_mapped);
+    _mapped= keep;
+  }
+  return true;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+bool Engine::snapshot(const stdstr& file) const {
+  std::vector<char> blob;
+  snapshot(blob);
+  auto fp= ::fopen(file.c_str(), "wb");
+  if (E_NIL(fp)) { return false; }
+  auto ok= ::fwrite(blob.data(), 1, blob.size(), fp) == blob.size();
+  ok= (::fclose(fp) == 0) && ok;
+  return ok;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+bool MappedSnapshot::open(const stdstr& file) {
+  close();
+#if defined(_WIN32)
+  // no mmap here, read it all in
+  std::ifstream in(file, std::ios::binary);
+  if (!in) { return false; }
+  _copy.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  _bytes= _copy.data();
+  _len= _copy.size();
+#else
+  auto fd= ::open(file.c_str(), O_RDONLY);
+  if (fd < 0) { return false; }
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+    ::close(fd);
+    return false;
+  }
+  auto p= ::mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping keeps the file alive
+  ::close(fd);
+  if (p == MAP_FAILED) { return false; }
+  _bytes= (const char*) p;
+  _len= st.st_size;
+#endif
+  if (!_image.parse(_bytes, _len)) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void MappedSnapshot::close() {
+#if !defined(_WIN32)
+  if (X_NIL(_bytes)) { ::munmap((void*) _bytes, _len); }
+#endif
+  _copy.clear();
+  _image= SnapshotImage();
+  _bytes=NULL;
+  _len=0;
+}
+
+
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+//EOF
+
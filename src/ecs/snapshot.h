@@ -0,0 +1,245 @@
+#pragma once
+/* Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
+
+//////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <type_traits>
+#include "pod.h"
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+namespace czlab::ecs {
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// Knows how to turn one component type into fixed size bytes
+// and back, see snapshotable<T>().
+struct MSVC_DLL Codec {
+
+  Cid cid() const { return _cid; }
+  const stdstr& name() const { return _name; }
+  size_t size() const { return _size; }
+
+  // true if the type is kept by value, its column is then
+  // copied as a whole, see Registry::column()
+  virtual bool byValue() const { return false; }
+  // the by value column of the type in r, made if missing
+  virtual Column* column(Registry* r) const { return NULL; }
+  // true for tags, whose records are empty
+  virtual bool isTag() const { return false; }
+
+  // copy n components into a packed array of size() byte records
+  virtual void save(Component* const* cs, size_t n, char* out) const {}
+  // make a component out of one record
+  virtual Component* load(const char* in) const { return NULL; }
+
+  virtual ~Codec() {}
+
+  protected:
+
+  Codec(Cid cid, const stdstr& name, size_t size) {
+    _cid=cid; _name=name; _size=size;
+  }
+
+  stdstr _name;
+  size_t _size;
+  Cid _cid;
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// A Component whose state lives in a trivially copyable
+// member called pod, e.g.
+//   struct Loc : public Component { struct { float x,y; } pod; };
+template<typename T>
+struct PodCodec : public Codec {
+
+  typedef decltype(T::pod) Pod;
+  static_assert(std::is_trivially_copyable_v<Pod>,
+                "snapshot needs a trivially copyable pod member");
+
+  virtual void save(Component* const* cs, size_t n, char* out) const {
+    for (size_t i=0; i < n; ++i) {
+      ::memcpy(out + i*sizeof(Pod), &s__cast(T,cs[i])->pod, sizeof(Pod));
+    }
+  }
+
+  virtual Component* load(const char* in) const {
+    auto c= new T();
+    ::memcpy(&c->pod, in, sizeof(Pod));
+    return c;
+  }
+
+  PodCodec(const stdstr& name)
+    : Codec(EntityFeature<T>::id(), name, sizeof(Pod)) {}
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// A plain struct component, the records are the values themselves.
+template<typename T>
+struct ValueCodec : public Codec {
+
+  virtual bool byValue() const { return true; }
+
+  virtual Column* column(Registry* r) const {
+    r->template reifyColumn<T>();
+    return r->column(_cid);
+  }
+
+  ValueCodec(const stdstr& name)
+    : Codec(EntityFeature<T>::id(), name, sizeof(T)) {}
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// A tag, only which entities have it is saved.
+template<typename T>
+struct TagCodec : public Codec {
+
+  virtual bool isTag() const { return true; }
+
+  TagCodec(const stdstr& name)
+    : Codec(EntityFeature<T>::id(), name, 0) {}
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// what a record of T looks like in a snapshot
+template<typename T, bool = isPod<T>>
+struct SnapRecord { typedef T type; };
+
+template<typename T>
+struct SnapRecord<T,false> { typedef decltype(T::pod) type; };
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// All known codecs.  Register every type before taking or
+// restoring snapshots, the name is what ties a column in a
+// snapshot to its type so keep it stable across builds.
+struct MSVC_DLL Codecs {
+
+  // takes ownership
+  static void add(Codec*);
+  static Codec* find(const stdstr& name);
+  static Codec* find(Cid);
+  static std::vector<Codec*> all();
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// A checked, read only look into snapshot bytes, nothing is
+// copied so the bytes must outlive it.
+struct MSVC_DLL SnapshotImage {
+
+  struct Column {
+    stdstr name;
+    Cid cid;
+    size_t size;
+    size_t count;
+    // slot index of each record
+    const uint32_t* index;
+    const char* data;
+  };
+
+  // false if the bytes are not a well formed snapshot
+  bool parse(const char* bytes, size_t len);
+
+  // the column saved under this name, or NULL
+  const Column* column(const stdstr& name) const;
+
+  // the records of T's column used in place, count is set
+  // to how many there are.  NULL if T is not in the image
+  template<typename T>
+  const typename SnapRecord<T>::type* pods(const stdstr& name, size_t& count) const;
+
+  size_t slots=0;
+  size_t sigWords=0;
+  size_t nfree=0;
+  // GEN_LIVE is set on the live slots
+  const uint32_t* gens=NULL;
+  const uint64_t* sigs=NULL;
+  const uint32_t* frees=NULL;
+  std::vector<Column> columns;
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// A snapshot file mapped into memory.  Pages are only read in
+// when touched, so opening a big world is close to free, and the
+// columns can be read in place with image().pods<T>().
+//
+// Engine::restore(image()) copies every record in.  Handing the
+// whole thing to Engine::restore(MappedSnapshot*) instead lets
+// by value columns use the mapped records in place, each column
+// is only copied in when first asked for mutably, e.g. by get(),
+// edit() or a view.  Components are made one by one either way.
+struct MSVC_DLL MappedSnapshot {
+
+  // false if the file cannot be mapped or is not a snapshot
+  bool open(const stdstr& file);
+  void close();
+
+  bool isOpen() const { return X_NIL(_bytes); }
+  const SnapshotImage& image() const { return _image; }
+  const char* data() const { return _bytes; }
+  size_t size() const { return _len; }
+
+  MappedSnapshot() {}
+  ~MappedSnapshot() { close(); }
+
+  private:
+
+  SnapshotImage _image;
+  const char* _bytes=NULL;
+  size_t _len=0;
+  // owned copy when the platform cannot map files
+  std::vector<char> _copy;
+
+  MappedSnapshot(const MappedSnapshot&) = delete;
+  MappedSnapshot& operator=(const MappedSnapshot&) = delete;
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+const typename SnapRecord<T>::type* SnapshotImage::pods(const stdstr& name, size_t& count) const {
+  typedef typename SnapRecord<T>::type Pod;
+  // records start on 8 byte boundaries
+  static_assert(alignof(Pod) <= 8, "pod is over aligned for in place use");
+  count=0;
+  auto c= column(name);
+  if (E_NIL(c) || c->size != sizeof(Pod)) { return NULL; }
+  count= c->count;
+  return reinterpret_cast<const Pod*>(c->data);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// include T in snapshots, either a Component with a pod member,
+// a plain struct kept by value or a tag.  No-op if already there.
+// By default the name is typeName<T>(), which stays the same from
+// build to build, and across compilers for plain user types.  Pass
+// a name for anything else that must load on another compiler
+template<typename T>
+void snapshotable(const stdstr& name= stdstr(EntityFeature<T>::name())) {
+  if (X_NIL(Codecs::find(EntityFeature<T>::id()))) {
+    return;
+  }
+  if constexpr (isTag<T>) {
+    Codecs::add(new TagCodec<T>(name));
+  } else if constexpr (isPod<T>) {
+    Codecs::add(new ValueCodec<T>(name));
+  } else {
+    Codecs::add(new PodCodec<T>(name));
+  }
+}
+
+
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+//EOF
+
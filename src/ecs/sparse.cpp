@@ -0,0 +1,117 @@
+/* Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
+
+#include "sparse.h"
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+namespace czlab::ecs {
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+SparseRegistry::~SparseRegistry() {
+  for (auto p : _pools) { DEL_PTR(p); }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+SparseSet<EComponent>* SparseRegistry::pool(Cid cid) const {
+  return (cid >= 0 && cid < (Cid)_pools.size()) ? _pools[cid] : NULL;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void SparseRegistry::put(Cid cid, EntityId eid, EComponent c) {
+  if (cid >= (Cid)_pools.size()) {
+    _pools.resize(cid+1, NULL);
+  }
+  if (E_NIL(_pools[cid])) {
+    _pools[cid]= new SparseSet<EComponent>();
+  }
+  _pools[cid]->add(eid, c);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void SparseRegistry::remove(Cid cid, EntityId eid) {
+  if (auto p= pool(cid); X_NIL(p)) {
+    p->remove(eid);
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+Component* SparseRegistry::lookup(Cid cid, EntityId eid) const {
+  if (auto p= pool(cid); X_NIL(p)) {
+    if (auto c= p->get(eid); X_NIL(c)) {
+      return c->ptr();
+    }
+  }
+  return NULL;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void SparseRegistry::collect(const std::vector<Cid>& cs, std::vector<EntityId>& out) const {
+  std::vector<SparseSet<EComponent>*> ps;
+  SparseSet<EComponent>* pm=NULL;
+
+  //iterate the smallest pool, probe the rest
+  for (auto& cid : cs) {
+    auto p= pool(cid);
+    if (E_NIL(p)) { return; }
+    if (E_NIL(pm) || p->size() < pm->size()) { pm=p; }
+    s__conj(ps, p);
+  }
+
+  if (E_NIL(pm)) { return; }
+
+  for (auto eid : pm->ids()) {
+    auto ok=true;
+    for (auto p : ps) {
+      if (p != pm && !p->has(eid)) { ok=false; break; }
+    }
+    if (ok) { s__conj(out, eid); }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void SparseRegistry::purge(EntityId eid) {
+  for (auto p : _pools) {
+    if (X_NIL(p)) { p->remove(eid); }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void SparseRegistry::sweep(const std::vector<uint8_t>& dead) {
+  for (auto p : _pools) {
+    if (X_NIL(p)) { p->sweep(dead); }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void SparseRegistry::gather(Cid cid, std::vector<EntityId>& eids, std::vector<Component*>& cs) const {
+  if (auto p= pool(cid); X_NIL(p)) {
+    s__ccat(eids, p->ids());
+    cs.reserve(cs.size() + p->size());
+    for (auto& c : p->data()) { s__conj(cs, c.ptr()); }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void SparseRegistry::clear() {
+  for (auto p : _pools) {
+    if (X_NIL(p)) { p->clear(); }
+  }
+}
+
+
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+//EOF
+
@@ -0,0 +1,339 @@
+#pragma once
+/* Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
+
+//////////////////////////////////////////////////////////////////////////////
+
+#include <cassert>
+#include <numeric>
+#include "types.h"
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+namespace czlab::ecs {
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// A packed array of values plus a paged sparse index keyed by
+// entity, add/remove/has are O(1) and iteration is dense.
+template<typename V>
+struct MSVC_DLL SparseSet {
+
+  const std::vector<EntityId>& ids() const { return _dense; }
+  std::vector<V>& data() { own(); return _data; }
+  // the values in the order of ids(), borrowed or not
+  const V* values() const {
+    auto x= _ext.load(std::memory_order_acquire);
+    return X_NIL(x) ? x : _data.data();
+  }
+  size_t size() const { return _dense.size(); }
+
+  bool has(EntityId) const;
+  V* get(EntityId);
+  const V* get(EntityId) const;
+
+  // no-op if already present
+  void add(EntityId, const V&);
+  // append n at once, none of them may be present
+  void load(const EntityId*, const V*, size_t n);
+  void fill(const EntityId*, const V&, size_t n);
+  // like load() into an empty set, but the ids are taken over
+  // and the values are read from vs in place until something
+  // asks for them mutably, then they are copied in.  vs must
+  // outlive that, or the next clear()
+  void borrow(std::vector<EntityId>& eids, const V* vs);
+  bool isBorrowed() const { return X_NIL(_ext.load(std::memory_order_acquire)); }
+  bool remove(EntityId);
+  void clear();
+  // remove the entities whose slot index is flagged, in
+  // one pass
+  void sweep(const std::vector<uint8_t>& dead);
+
+  // reorder by less on the values, the index follows
+  template<typename C>
+  void sort(C less);
+
+  SparseSet() {}
+  ~SparseSet();
+
+  private:
+
+  static constexpr size_t PAGE= 4096;
+  static constexpr uint32_t NONE= UINT32_MAX;
+
+  uint32_t* page(size_t, bool);
+  uint32_t at(EntityId) const;
+  // copy borrowed values in, safe from many threads
+  void own();
+
+  std::vector<uint32_t*> _pages;
+  std::vector<EntityId> _dense;
+  std::vector<V> _data;
+  std::atomic<const V*> _ext{NULL};
+  std::mutex _owning;
+
+  SparseSet(const SparseSet&) = delete;
+  SparseSet& operator=(const SparseSet&) = delete;
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// Registry backend using one sparse set per component type.
+struct MSVC_DLL SparseRegistry : public Registry {
+
+  virtual void put(Cid, EntityId, EComponent);
+  virtual void remove(Cid, EntityId);
+  virtual Component* lookup(Cid, EntityId) const;
+  virtual void collect(const std::vector<Cid>&, std::vector<EntityId>&) const;
+  virtual void purge(EntityId);
+  virtual void sweep(const std::vector<uint8_t>&);
+  virtual void gather(Cid, std::vector<EntityId>&, std::vector<Component*>&) const;
+  virtual void clear();
+
+  // the pool for this type, or NULL
+  SparseSet<EComponent>* pool(Cid) const;
+
+  template<typename T>
+  SparseSet<EComponent>* pool() const {
+    return pool(EntityFeature<T>::id());
+  }
+
+  virtual ~SparseRegistry();
+  SparseRegistry() {}
+
+  private:
+
+  std::vector<SparseSet<EComponent>*> _pools;
+
+  SparseRegistry(const SparseRegistry&) = delete;
+  SparseRegistry& operator=(const SparseRegistry&) = delete;
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename V>
+SparseSet<V>::~SparseSet() {
+  for (auto p : _pages) { DEL_ARRAY(p); }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename V>
+uint32_t* SparseSet<V>::page(size_t n, bool create) {
+  if (n >= _pages.size()) {
+    if (!create) { return NULL; }
+    _pages.resize(n+1, NULL);
+  }
+  if (E_NIL(_pages[n]) && create) {
+    _pages[n]= new uint32_t[PAGE];
+    std::fill(_pages[n], _pages[n]+PAGE, NONE);
+  }
+  return _pages[n];
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename V>
+uint32_t SparseSet<V>::at(EntityId eid) const {
+  size_t k= entIndex(eid);
+  size_t n= k / PAGE;
+  if (n < _pages.size() && X_NIL(_pages[n])) {
+    auto i= _pages[n][k % PAGE];
+    // a stale handle may share the slot index
+    return (i != NONE && _dense[i] == eid) ? i : NONE;
+  } else {
+    return NONE;
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename V>
+bool SparseSet<V>::has(EntityId eid) const {
+  return at(eid) != NONE;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename V>
+V* SparseSet<V>::get(EntityId eid) {
+  auto i= at(eid);
+  if (i == NONE) { return NULL; }
+  own();
+  return &_data[i];
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename V>
+const V* SparseSet<V>::get(EntityId eid) const {
+  auto i= at(eid);
+  return i == NONE ? NULL : values() + i;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename V>
+void SparseSet<V>::own() {
+  if (E_NIL(_ext.load(std::memory_order_acquire))) { return; }
+  std::lock_guard<std::mutex> g(_owning);
+  if (auto x= _ext.load(std::memory_order_relaxed); X_NIL(x)) {
+    _data.assign(x, x + _dense.size());
+    _ext.store(NULL, std::memory_order_release);
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename V>
+void SparseSet<V>::add(EntityId eid, const V& v) {
+  own();
+  size_t k= entIndex(eid);
+  auto p= page(k / PAGE, true);
+  auto i= p[k % PAGE];
+  if (i == NONE) {
+    p[k % PAGE]= (uint32_t) _dense.size();
+    s__conj(_dense, eid);
+    s__conj(_data, v);
+  } else if (_dense[i] != eid) {
+    // left over from a dead entity, take it over
+    _dense[i]= eid;
+    _data[i]= v;
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename V>
+void SparseSet<V>::load(const EntityId* eids, const V* vs, size_t n) {
+  own();
+  auto base= _dense.size();
+  _dense.insert(_dense.end(), eids, eids + n);
+  _data.insert(_data.end(), vs, vs + n);
+  for (size_t i=0; i < n; ++i) {
+    size_t k= entIndex(eids[i]);
+    page(k / PAGE, true)[k % PAGE]= (uint32_t)(base + i);
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename V>
+void SparseSet<V>::borrow(std::vector<EntityId>& eids, const V* vs) {
+  assert(_dense.empty());
+  _dense.swap(eids);
+  _data.clear();
+  auto n= _dense.size();
+  uint32_t* p=NULL;
+  size_t at= SIZE_MAX;
+  for (size_t i=0; i < n; ++i) {
+    size_t k= entIndex(_dense[i]);
+    if (k / PAGE != at) { at= k / PAGE; p= page(at, true); }
+    p[k % PAGE]= (uint32_t) i;
+  }
+  _ext.store(n > 0 ? vs : NULL, std::memory_order_release);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename V>
+void SparseSet<V>::fill(const EntityId* eids, const V& v, size_t n) {
+  own();
+  auto base= _dense.size();
+  _dense.insert(_dense.end(), eids, eids + n);
+  _data.insert(_data.end(), n, v);
+  // batches are mostly runs of slots, look up each page once
+  uint32_t* p=NULL;
+  size_t at= SIZE_MAX;
+  for (size_t i=0; i < n; ++i) {
+    size_t k= entIndex(eids[i]);
+    if (k / PAGE != at) { at= k / PAGE; p= page(at, true); }
+    p[k % PAGE]= (uint32_t)(base + i);
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename V>
+bool SparseSet<V>::remove(EntityId eid) {
+  size_t k= entIndex(eid);
+  auto p= page(k / PAGE, false);
+  if (E_NIL(p) || p[k % PAGE] == NONE || _dense[p[k % PAGE]] != eid) {
+    return false;
+  }
+  own();
+  auto i= p[k % PAGE];
+  auto last= _dense.size()-1;
+  if (i != last) {
+    // move the tail into the hole
+    size_t t= entIndex(_dense[last]);
+    _dense[i]= _dense[last];
+    _data[i]= _data[last];
+    _pages[t / PAGE][t % PAGE]= i;
+  }
+  p[k % PAGE]= NONE;
+  _dense.pop_back();
+  _data.pop_back();
+  return true;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename V>
+void SparseSet<V>::sweep(const std::vector<uint8_t>& dead) {
+  // fill each hole from the tail, like remove().  Going from the
+  // end means whatever moves in has been looked at already
+  own();
+  auto ds= _dense.data();
+  auto vs= _data.data();
+  auto flags= dead.data();
+  auto nf= dead.size();
+  auto end= _dense.size();
+  for (auto i= end; i-- > 0;) {
+    size_t k= entIndex(ds[i]);
+    if (k >= nf || !flags[k]) { continue; }
+    _pages[k / PAGE][k % PAGE]= NONE;
+    if (i != --end) {
+      size_t t= entIndex(ds[end]);
+      ds[i]= ds[end];
+      vs[i]= std::move(vs[end]);
+      _pages[t / PAGE][t % PAGE]= (uint32_t) i;
+    }
+  }
+  _dense.erase(_dense.begin() + end, _dense.end());
+  _data.erase(_data.begin() + end, _data.end());
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename V>
+template<typename C>
+void SparseSet<V>::sort(C less) {
+  own();
+  std::vector<uint32_t> order(_dense.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&](uint32_t a, uint32_t b) { return less(_data[a], _data[b]); });
+  std::vector<EntityId> ds(order.size());
+  std::vector<V> vs;
+  vs.reserve(order.size());
+  for (size_t i=0; i < order.size(); ++i) {
+    size_t k= entIndex(ds[i]= _dense[order[i]]);
+    s__conj(vs, std::move(_data[order[i]]));
+    _pages[k / PAGE][k % PAGE]= (uint32_t) i;
+  }
+  _dense.swap(ds);
+  _data.swap(vs);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename V>
+void SparseSet<V>::clear() {
+  for (auto p : _pages) {
+    if (X_NIL(p)) { std::fill(p, p+PAGE, NONE); }
+  }
+  _dense.clear();
+  _data.clear();
+  _ext.store(NULL, std::memory_order_release);
+}
+
+
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+//EOF
+
@@ -0,0 +1,184 @@
+/* Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
+
+#include "spatial.h"
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+namespace czlab::ecs {
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+Grid::Grid(float cell) {
+  assert(cell > 0);
+  _cell= cell;
+  clear();
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Grid::clear() {
+  _cells.clear();
+  _where.clear();
+  _count=0;
+  _lo[0]= _lo[1]= std::numeric_limits<int32_t>::max();
+  _hi[0]= _hi[1]= std::numeric_limits<int32_t>::min();
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+const std::vector<Grid::Item>* Grid::at(int32_t cx, int32_t cy) const {
+  auto i= _cells.find(key(cx,cy));
+  return i == _cells.end() || i->second.empty() ? NULL : &i->second;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Grid::unlink(Where& w) {
+  // swap with the last one in the cell
+  auto& c= _cells[w.key];
+  auto& last= c.back();
+  c[w.at]= last;
+  _where[entIndex(last.eid)].at= w.at;
+  c.pop_back();
+  w.eid=0;
+  --_count;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Grid::put(EntityId e, float x, float y) {
+  auto i= entIndex(e);
+  if (i >= _where.size()) {
+    // no entity has handle 0, generations start at 1
+    _where.resize(i+1, Where{ 0, 0, 0 });
+  }
+  auto cx= coord(x);
+  auto cy= coord(y);
+  auto k= key(cx,cy);
+  auto& w= _where[i];
+  if (w.eid == e && w.key == k) {
+    // moved within the cell
+    auto& it= _cells[k][w.at];
+    it.x=x;
+    it.y=y;
+    return;
+  }
+  // moved out, or a dead entity still holds the slot
+  if (w.eid != 0) { unlink(w); }
+  auto& c= _cells[k];
+  w= Where{ e, k, (uint32_t) c.size() };
+  s__conj(c, (Item{ e, x, y }));
+  ++_count;
+  _lo[0]= std::min(_lo[0], cx); _hi[0]= std::max(_hi[0], cx);
+  _lo[1]= std::min(_lo[1], cy); _hi[1]= std::max(_hi[1], cy);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+bool Grid::drop(EntityId e) {
+  auto i= entIndex(e);
+  if (i >= _where.size() || _where[i].eid != e) { return false; }
+  unlink(_where[i]);
+  return true;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Grid::rect(float x0, float y0, float x1, float y1, std::vector<EntityId>& out) const {
+  if (_count == 0) { return; }
+  // only the cells which may hold something
+  auto cx0= std::max(coord(x0), _lo[0]), cx1= std::min(coord(x1), _hi[0]);
+  auto cy0= std::max(coord(y0), _lo[1]), cy1= std::min(coord(y1), _hi[1]);
+  for (auto cy= cy0; cy <= cy1; ++cy)
+  for (auto cx= cx0; cx <= cx1; ++cx) {
+    if (auto c= at(cx,cy); X_NIL(c)) {
+      for (auto& it : *c) {
+        if (it.x >= x0 && it.x <= x1 && it.y >= y0 && it.y <= y1) {
+          s__conj(out, it.eid);
+        }
+      }
+    }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Grid::range(float x, float y, float r, std::vector<EntityId>& out) const {
+  if (_count == 0) { return; }
+  auto rr= r*r;
+  auto cx0= std::max(coord(x-r), _lo[0]), cx1= std::min(coord(x+r), _hi[0]);
+  auto cy0= std::max(coord(y-r), _lo[1]), cy1= std::min(coord(y+r), _hi[1]);
+  for (auto cy= cy0; cy <= cy1; ++cy)
+  for (auto cx= cx0; cx <= cx1; ++cx) {
+    if (auto c= at(cx,cy); X_NIL(c)) {
+      for (auto& it : *c) {
+        auto dx= it.x - x, dy= it.y - y;
+        if (dx*dx + dy*dy <= rr) { s__conj(out, it.eid); }
+      }
+    }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Grid::nearest(float x, float y, size_t k,
+                   std::vector<EntityId>& out, float maxR) const {
+  if (k == 0 || _count == 0) { return; }
+  typedef std::pair<float,EntityId> Hit;
+  static thread_local std::vector<Hit> hits;
+  hits.clear();
+  auto cx= coord(x), cy= coord(y);
+  auto rr= maxR < std::sqrt(std::numeric_limits<float>::max())
+           ? maxR*maxR : std::numeric_limits<float>::max();
+
+  auto scan= [&](int32_t i, int32_t j) {
+    if (i < _lo[0] || i > _hi[0] || j < _lo[1] || j > _hi[1]) { return; }
+    if (auto c= at(i,j); X_NIL(c)) {
+      for (auto& it : *c) {
+        auto dx= it.x - x, dy= it.y - y;
+        auto d= dx*dx + dy*dy;
+        if (d <= rr) { s__conj(hits, std::make_pair(d, it.eid)); }
+      }
+    }
+  };
+
+  // grow square rings of cells around (x,y).  After ring R
+  // anything not seen is more than R cells away, so stop once
+  // the k-th best is closer than that.  No ring closer than
+  // the used cells has anything in it
+  int32_t R= std::max({ _lo[0]-cx, cx-_hi[0], _lo[1]-cy, cy-_hi[1], 0 });
+  for (; ; ++R) {
+    auto j0= std::max(cy-R, _lo[1]), j1= std::min(cy+R, _hi[1]);
+    for (auto j= j0; j <= j1; ++j) {
+      if (j == cy-R || j == cy+R) {
+        auto i0= std::max(cx-R, _lo[0]), i1= std::min(cx+R, _hi[0]);
+        for (auto i= i0; i <= i1; ++i) { scan(i,j); }
+      } else {
+        scan(cx-R, j);
+        scan(cx+R, j);
+      }
+    }
+    auto seen= (float)R * _cell;
+    if (hits.size() >= k) {
+      std::nth_element(hits.begin(), hits.begin() + (k-1), hits.end());
+      if (hits[k-1].first <= seen*seen) { break; }
+    }
+    // past maxR, or every used cell is inside the rings
+    if (seen >= maxR ||
+        (cx-R <= _lo[0] && cx+R >= _hi[0] &&
+         cy-R <= _lo[1] && cy+R >= _hi[1])) { break; }
+  }
+
+  auto n= std::min(k, hits.size());
+  std::partial_sort(hits.begin(), hits.begin() + n, hits.end());
+  for (size_t i=0; i < n; ++i) { s__conj(out, hits[i].second); }
+}
+
+
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+//EOF
+
@@ -0,0 +1,187 @@
+#pragma once
+/* Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
+
+//////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+#include "pod.h"
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+namespace czlab::ecs {
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// Points on a uniform grid of square cells, pick a cell about
+// the size of a typical query radius.  Knows nothing about the
+// engine, see Spatial<T> for one kept up to date by it.
+struct MSVC_DLL Grid {
+
+  // add the entity, or move it if already there
+  void put(EntityId, float x, float y);
+  bool drop(EntityId);
+  void clear();
+
+  size_t size() const { return _count; }
+  float cell() const { return _cell; }
+
+  // append entities within r of (x,y)
+  void range(float x, float y, float r, std::vector<EntityId>&) const;
+
+  // append entities inside the box
+  void rect(float x0, float y0, float x1, float y1, std::vector<EntityId>&) const;
+
+  // append the k entities closest to (x,y), closest first,
+  // none further than maxR
+  void nearest(float x, float y, size_t k, std::vector<EntityId>&,
+               float maxR= std::numeric_limits<float>::max()) const;
+
+  explicit Grid(float cell);
+  ~Grid() {}
+
+  private:
+
+  struct Item {
+    EntityId eid;
+    float x, y;
+  };
+
+  // where each entity sits, by slot index
+  struct Where {
+    EntityId eid;
+    uint64_t key;
+    uint32_t at;
+  };
+
+  int32_t coord(float v) const { return (int32_t) std::floor(v / _cell); }
+  static uint64_t key(int32_t cx, int32_t cy) {
+    return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;
+  }
+  const std::vector<Item>* at(int32_t cx, int32_t cy) const;
+  void unlink(Where&);
+
+  std::unordered_map<uint64_t,std::vector<Item>> _cells;
+  std::vector<Where> _where;
+  size_t _count=0;
+  float _cell;
+  // cells ever used, bounds the search of nearest()
+  int32_t _lo[2];
+  int32_t _hi[2];
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// A Grid over every entity having T, which needs float members
+// x and y, a plain struct or a Component.  Entities come and go
+// through observer events, moves are picked up by sync() from
+// the change ticks, so flag them with touch() or edit().  Call
+// sync() once a frame after Engine::update(), the queries may
+// then run from many systems at once.
+template<typename T>
+struct Spatial : public Observer {
+
+  // read the changes since the last call
+  void sync();
+
+  const Grid& grid() const { return _grid; }
+
+  // as in Grid, but only live entities
+  void range(float x, float y, float r, std::vector<EntityId>& out) const {
+    auto n= out.size();
+    _grid.range(x, y, r, out);
+    prune(out, n);
+  }
+
+  void rect(float x0, float y0, float x1, float y1, std::vector<EntityId>& out) const {
+    auto n= out.size();
+    _grid.rect(x0, y0, x1, y1, out);
+    prune(out, n);
+  }
+
+  void nearest(float x, float y, size_t k, std::vector<EntityId>& out,
+               float maxR= std::numeric_limits<float>::max()) const {
+    auto n= out.size();
+    _grid.nearest(x, y, k, out, maxR);
+    prune(out, n);
+  }
+
+  virtual void onAdd(Cid, EntityId e) { pull(e); }
+  virtual void onRemove(Cid, EntityId e) {
+    // removed and added back within the frame
+    if (E_NIL(lookup(e))) { _grid.drop(e); }
+  }
+
+  Spatial(Engine* e, float cell) : _grid(cell) {
+    _engine= e;
+    _engine->template observe<T>(this);
+    _since=0;
+    sync();
+  }
+
+  virtual ~Spatial() { _engine->unobserve(this); }
+
+  private:
+
+  T* lookup(EntityId) const;
+  void pull(EntityId);
+  void prune(std::vector<EntityId>&, size_t from) const;
+
+  std::vector<EntityId> _buf;
+  Engine* _engine;
+  uint64_t _since;
+  Grid _grid;
+
+  Spatial(const Spatial&) = delete;
+  Spatial& operator=(const Spatial&) = delete;
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+void Spatial<T>::sync() {
+  _buf.clear();
+  _since= _engine->template changed<T>(_since, _buf);
+  for (auto e : _buf) { pull(e); }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+T* Spatial<T>::lookup(EntityId e) const {
+  if constexpr (isPod<T>) {
+    return _engine->rego()->template tryGet<T>(e);
+  } else {
+    return _engine->rego()->template find<T>(e);
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+void Spatial<T>::pull(EntityId e) {
+  if (auto p= lookup(e); X_NIL(p)) { _grid.put(e, p->x, p->y); }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+void Spatial<T>::prune(std::vector<EntityId>& out, size_t from) const {
+  // purged since the last notify(), keeps the order
+  auto i= std::remove_if(out.begin() + from, out.end(),
+                         [this](EntityId e) { return !_engine->isAlive(e); });
+  out.erase(i, out.end());
+}
+
+
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+//EOF
+
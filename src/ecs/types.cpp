@@ -12,13 +12,40 @@
  *
  * Copyright (c) 2013-2016, Kenneth Leung. All rights reserved. */
 
+#include <cmath>
 #include <iostream>
 #include "types.h"
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 namespace czlab::ecs {
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
-Cid EntityFeatureBase::_lastId = 0;
+std::atomic<Cid> EntityFeatureBase::_lastId(0);
+
+// type name hash => id, only written the first time a type is used
+static std::mutex _typeLock;
+static std::map<uint64_t,Cid>& _typesByHash() {
+  static std::map<uint64_t,Cid> _m;
+  return _m;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+Cid EntityFeatureBase::enlist(uint64_t hash) {
+  auto id= ++_lastId;
+  std::lock_guard<std::mutex> g(_typeLock);
+  // two types with one name, e.g. in anonymous namespaces of
+  // different files, still get their own ids, the first one
+  // keeps the hash
+  _typesByHash().insert(std::make_pair(hash, id));
+  return id;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+Cid EntityFeatureBase::find(uint64_t hash) {
+  std::lock_guard<std::mutex> g(_typeLock);
+  auto& m= _typesByHash();
+  auto i= m.find(hash);
+  return i == m.end() ? 0 : i->second;
+}
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 Component::~Component() {
@@ -26,22 +53,214 @@ Component::~Component() {
 }
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
-Registry::~Registry() {
-  for (auto i=_rego.begin(),e=_rego.end();i!=e;++i) {
-    DEL_PTR(i->second);
+static bool _overlaps(const std::vector<Cid>& a, const std::vector<Cid>& b) {
+  for (auto x : a) {
+    if (std::find(b.begin(), b.end(), x) != b.end()) { return true; }
   }
+  return false;
 }
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
-MapEidC* Registry::getCache(const Cid& z) const {
-  if (auto i=_rego.find(z); i != _rego.end()) {
-    return i->second;
+bool System::conflicts(const System* s) const {
+  if (!_declared || !s->_declared) {
+    return true;
+  }
+  return _overlaps(_writes, s->_writes) ||
+         _overlaps(_writes, s->_reads) ||
+         _overlaps(_reads, s->_writes);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+bool System::run(float time, int maxSteps) {
+  if (_step <= 0) {
+    return update(time);
+  }
+  for (auto i=0, n= due(time, maxSteps); i < n; ++i) {
+    if (! update(_step)) { return false; }
+  }
+  return true;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+int System::due(float time, int maxSteps) {
+  if (_step <= 0) { return 0; }
+  _acc += time;
+  auto n= (int)(_acc / _step);
+  if (n > maxSteps) {
+    // too far behind, keep the fraction only
+    n= maxSteps;
+    _acc= std::fmod(_acc, _step);
   } else {
-    return NULL;
+    _acc -= n * _step;
+  }
+  return n;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+Registry::~Registry() {
+  for (auto m : _rego) { DEL_PTR(m); }
+  for (auto c : _pods) { DEL_PTR(c); }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+MapEidC* Registry::getCache(const Cid& z) const {
+  return (z >= 0 && z < (Cid)_rego.size()) ? _rego[z] : NULL;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Registry::attach(Cid cid, EntityId eid, EComponent c) {
+  if (_engine && !_engine->isAlive(eid)) { return; }
+  // every backend keeps the old one, so there is nothing to tell
+  if (X_NIL(lookup(cid, eid))) { return; }
+  put(cid, eid, c);
+  if (_engine) { _engine->bound(eid, cid); }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Registry::detach(Cid cid, EntityId eid) {
+  remove(cid, eid);
+  if (_engine) { _engine->unbound(eid, cid); }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Registry::put(Cid cid, EntityId eid, EComponent c) {
+  if (cid >= (Cid)_rego.size()) {
+    _rego.resize(cid+1, NULL);
+  }
+  if (E_NIL(_rego[cid])) {
+    _rego[cid]= new MapEidC;
+  }
+  _rego[cid]->insert(s__pair(EntityId,EComponent, eid, c));
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Registry::remove(Cid cid, EntityId eid) {
+  if (auto m= getCache(cid); X_NIL(m)) {
+    if (auto it2= m->find(eid); it2 != m->end()) {
+      m->erase(it2);
+    }
   }
 }
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+Component* Registry::lookup(Cid cid, EntityId eid) const {
+  if (auto m= getCache(cid); X_NIL(m)) {
+    if (auto it2= m->find(eid); it2 != m->end()) {
+      return it2->second.ptr();
+    }
+  }
+  return NULL;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Registry::collect(const std::vector<Cid>& cs, std::vector<EntityId>& out) const {
+  std::vector<MapEidC*> ccs;
+  MapEidC* pm=NULL;
+  size_t pmin= SIZE_MAX;
+
+  //find shortest cache, doing an intersection
+  for (auto& cid : cs) {
+    auto c= getCache(cid);
+    if (E_NIL(c)) {
+      DEBUG("cache missed on %s", N_STR(cid).c_str());
+      return;
+    }
+    if (c->size() < pmin) {
+      pmin= c->size();
+      pm=c;
+    }
+    s__conj(ccs, c);
+  }
+
+  DEBUG("intesection on %d caches", (int)ccs.size());
+
+  if (ccs.size() > 0) {
+    //use the shortest cache as the baseline
+    for (auto i= pm->begin(),e= pm->end();i != e;++i) {
+      auto eid= i->first;
+      size_t sum=0;
+      for (auto& c : ccs) {
+        // look for intersection
+        if (c == pm) { ++sum; continue; }
+        if (s__contains(*c, eid)) { ++sum; }
+      }
+      // if found in all caches...matched!
+      if (sum == ccs.size()) {
+        s__conj(out, eid);
+      }
+    }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Registry::purge(EntityId eid) {
+  for (auto m : _rego) {
+    if (E_NIL(m)) { continue; }
+    if (auto it2= m->find(eid); it2 != m->end()) {
+      m->erase(it2);
+    }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Registry::sweep(const std::vector<uint8_t>& dead) {
+  for (auto m : _rego) {
+    if (E_NIL(m)) { continue; }
+    for (auto i= m->begin(); i != m->end();) {
+      auto k= entIndex(i->first);
+      if (k < dead.size() && dead[k]) {
+        i= m->erase(i);
+      } else {
+        ++i;
+      }
+    }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Registry::gather(Cid cid, std::vector<EntityId>& eids, std::vector<Component*>& cs) const {
+  if (auto m= getCache(cid); X_NIL(m)) {
+    eids.reserve(eids.size() + m->size());
+    cs.reserve(cs.size() + m->size());
+    for (auto i=m->begin(),e=m->end();i!=e;++i) {
+      s__conj(eids, i->first);
+      s__conj(cs, i->second.ptr());
+    }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+Column* Registry::column(Cid cid) const {
+  return (cid >= 0 && cid < (Cid)_pods.size()) ? _pods[cid] : NULL;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Registry::dropPods(EntityId eid) {
+  for (auto c : _pods) {
+    if (X_NIL(c)) { c->remove(eid); }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Registry::sweepPods(const std::vector<uint8_t>& dead) {
+  for (auto c : _pods) {
+    if (X_NIL(c)) { c->sweep(dead); }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Registry::clearPods() {
+  for (auto c : _pods) {
+    if (X_NIL(c)) { c->clear(); }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void Registry::clear() {
+  for (auto m : _rego) {
+    if (X_NIL(m)) { m->clear(); }
+  }
+}
 
 
 
@@ -15,8 +15,15 @@
 
 //////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <string_view>
+#include <type_traits>
 #include "../nlohmann/json.hpp"
 #include "../aeon/smptr.h"
+#include "../aeon/Pool.h"
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 namespace czlab::ecs {
@@ -25,14 +32,36 @@ namespace a= czlab::aeon;
 namespace j= nlohmann;
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
-typedef long EntityId;
+// an entity handle, slot index in the low 32 bits and
+// the slot's generation in the high 32 bits
+typedef llong EntityId;
 typedef long Cid;
 
+inline uint32_t entIndex(EntityId e) { return (uint32_t)(e & 0xffffffff); }
+inline uint32_t entGen(EntityId e) { return (uint32_t)(e >> 32); }
+inline EntityId entHandle(uint32_t index, uint32_t gen) {
+  return ((EntityId)gen << 32) | index;
+}
+// generations use 31 bits, the engine sets the top one on the
+// slots that are alive
+inline constexpr uint32_t GEN_LIVE= 0x80000000;
+
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 struct Component;
 struct System;
 struct Entity;
 struct Engine;
+struct View;
+struct Jobs;
+struct Commands;
+struct Scheduler;
+struct Profiler;
+struct SnapshotImage;
+struct MappedSnapshot;
+struct Parcel;
+struct Prefab;
+struct Relation;
+template<typename V> struct SparseSet;
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 typedef a::RefPtr<Component> EComponent;
@@ -40,17 +69,154 @@ typedef a::RefPtr<System> ESystem;
 typedef a::RefPtr<Entity> EEntity;
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
-struct EntityFeatureBase {
+// the name of T as the compiler spells it, worked out at
+// compile time from the signature of this very function
+template<typename T>
+constexpr std::string_view spelledName() {
+#if defined(_MSC_VER)
+  std::string_view s= __FUNCSIG__;
+  auto b= s.find("spelledName<") + 12;
+  auto e= s.rfind(">(void)");
+#else
+  // [with T = X; ...] or [T = X]
+  std::string_view s= __PRETTY_FUNCTION__;
+  auto b= s.find("T = ") + 4;
+  auto e= s.find(';', b);
+  if (e == std::string_view::npos) { e= s.rfind(']'); }
+#endif
+  return s.substr(b, e-b);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+constexpr bool wordChar(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '_';
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// copy s into out minus what msvc adds and gcc/clang do not, the
+// class/struct/enum/union keywords and any space not between two
+// words, e.g. "struct a::B<class C, int> " becomes "a::B<C,int>"
+constexpr size_t tidyName(std::string_view s, char* out) {
+  constexpr std::string_view keys[]= { "class ", "struct ", "enum ", "union " };
+  size_t n=0;
+  for (size_t i=0; i < s.size();) {
+    if (i == 0 || !wordChar(s[i-1])) {
+      auto k= std::find_if(std::begin(keys), std::end(keys),
+                           [&](auto k) { return s.substr(i, k.size()) == k; });
+      if (k != std::end(keys)) { i += k->size(); continue; }
+    }
+    auto c= s[i++];
+    if (c == ' ' &&
+        !(n > 0 && wordChar(out[n-1]) && i < s.size() && wordChar(s[i]))) {
+      continue;
+    }
+    out[n++]= c;
+  }
+  return n;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+struct TidyName {
+  static constexpr auto spelled= spelledName<T>();
+  static constexpr auto buf= [] {
+    std::array<char, spelled.size()+1> a{};
+    tidyName(spelled, a.data());
+    return a;
+  }();
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// the name of T, the same from msvc, gcc and clang for plain
+// user types.  Names with std:: types, typedefs of builtins or
+// anonymous namespaces in them may still differ by compiler
+template<typename T>
+constexpr std::string_view typeName() {
+  return std::string_view(TidyName<T>::buf.data());
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+constexpr uint64_t fnv1a(std::string_view s) {
+  uint64_t h= 14695981039346656037ULL;
+  for (auto c : s) {
+    h= (h ^ (uint8_t)c) * 1099511628211ULL;
+  }
+  return h;
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// Type ids are 1..lastId() with no gaps, handed out on first use
+// so they can index arrays and bitsets, but the order depends on
+// the run.  The hash of the type name does not, use it to refer
+// to a type outside the process.  Shared by every engine, types
+// may show up first on any thread.
+struct MSVC_DLL EntityFeatureBase {
+  // the highest id handed out so far
+  static Cid lastId() { return _lastId; }
+  // the id of the type with this hash, 0 if not used yet
+  static Cid find(uint64_t hash);
   protected:
-  static Cid nextId() { return ++_lastId; }
-  static Cid _lastId;
+  static Cid enlist(uint64_t hash);
+  static std::atomic<Cid> _lastId;
 };
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 template<typename T>
 struct EntityFeature : public EntityFeatureBase {
   static Cid id() {
-    static Cid _id = nextId(); return _id; }
+    static Cid _id = enlist(hash()); return _id; }
+  static constexpr std::string_view name() { return typeName<T>(); }
+  static constexpr uint64_t hash() { return fnv1a(name()); }
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// Mix into a component (or anything) to get its memory from a
+// shared free list instead of the heap, e.g.
+//   struct Bullet : public Component, public Pooled<Bullet> {...}
+// Each thread keeps a small cache of blocks so the shared list
+// is only locked once per batch.  Subclasses of T which are
+// bigger than T go to the heap as usual.
+template<typename T>
+struct Pooled {
+
+  static void* operator new(size_t z) {
+    if (z != sizeof(T)) { return ::operator new(z); }
+    auto& c= cache();
+    if (c.n == 0) { c.n= list()->take(c.blocks, BATCH); }
+    return c.blocks[--c.n];
+  }
+
+  static void operator delete(void* p, size_t z) {
+    if (z != sizeof(T)) { ::operator delete(p); return; }
+    auto& c= cache();
+    if (c.n == 2*BATCH) {
+      c.n -= BATCH;
+      list()->drop(c.blocks + c.n, BATCH);
+    }
+    c.blocks[c.n++]= p;
+  }
+
+  private:
+
+  static constexpr int BATCH= 32;
+
+  struct Cache {
+    ~Cache() { if (n > 0) { list()->drop(blocks, n); } }
+    void* blocks[2*BATCH];
+    int n=0;
+  };
+
+  // never freed, blocks may outlive any thread or static
+  static a::FreeList* list() {
+    static a::FreeList* _list= new a::FreeList(sizeof(T), 1024);
+    return _list;
+  }
+
+  static Cache& cache() {
+    static thread_local Cache _cache;
+    return _cache;
+  }
 };
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
@@ -59,6 +225,11 @@ struct MSVC_DLL Component : public a::Counted {
   Component() {}
 };
 
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// true for types which are only a signature bit
+template<typename T>
+inline constexpr bool isTag= std::is_empty_v<T> && !std::is_base_of_v<Component,T>;
+
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 typedef std::map<EntityId,EComponent> MapEidC;
 typedef std::map<EntityId,EEntity> MapEidE;
@@ -66,10 +237,12 @@ typedef std::vector<EEntity> EntVec;
 typedef std::vector<EComponent> ComVec;
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
-struct MSVC_DLL Entity : public a::Counted {
+// An optional object wrapper over an entity handle, see Engine::ent().
+struct MSVC_DLL Entity : public a::Counted, public Pooled<Entity> {
 
   bool isOk() const { return !_dead; };
   EntityId id() const { return _eid; }
+  stdstr name() const;
 
   virtual ~Entity() {}
 
@@ -81,9 +254,10 @@ struct MSVC_DLL Entity : public a::Counted {
   EntityId _eid;
   stdstr _name;
 
-  Entity(Engine*, const stdstr&);
-  Entity(Engine*);
+  Entity(Engine*, EntityId, const stdstr&);
+  Entity(Engine*, EntityId);
   void die() { _dead=true; }
+  void revive(EntityId, const stdstr&);
 
   Entity(const Entity&) = delete;
   Entity() = delete;
@@ -103,44 +277,272 @@ struct MSVC_DLL System : public a::Counted {
   virtual void preamble() = 0;
   virtual int priority() const = 0;
 
+  // component types touched by update(), a system which
+  // declares nothing is assumed to touch everything
+  const std::vector<Cid>& readSet() const { return _reads; }
+  const std::vector<Cid>& writeSet() const { return _writes; }
+  bool declared() const { return _declared; }
+
+  // true if the two systems cannot run at the same time
+  bool conflicts(const System*) const;
+
+  // seconds per update of a fixed rate system, 0 if it runs
+  // once per engine update with the frame time
+  float step() const { return _step; }
+
+  // how far into the next fixed step the clock is, [0,1).
+  // Blend the last two states by this to draw smoothly
+  float alpha() const { return _step > 0 ? _acc / _step : 1; }
+
+  // one engine update worth of this system, which for a fixed
+  // rate system is as many steps as the time covers, at most
+  // maxSteps.  Returns what update() did
+  bool run(float time, int maxSteps);
+
+  // the number of fixed steps the time covers, the clock moves
+  // on by that many.  For callers doing the update() themselves
+  int due(float time, int maxSteps);
+
   virtual ~System() {}
 
   protected:
 
   System(Engine* e) { _engine= e; }
 
+  template<typename... T>
+  void reads() {
+    _declared=true;
+    (s__conj(_reads, EntityFeature<T>::id()), ...);
+  }
+
+  template<typename... T>
+  void writes() {
+    _declared=true;
+    (s__conj(_writes, EntityFeature<T>::id()), ...);
+  }
+
+  // update() at this many hertz, always with time set to
+  // 1/hz, whatever the frame rate.  0 goes back to once a frame
+  void rate(float hz) {
+    _step= hz > 0 ? 1/hz : 0;
+    _acc=0;
+  }
+
+  std::vector<Cid> _reads;
+  std::vector<Cid> _writes;
+  bool _declared=false;
   Engine* _engine;
   bool _active=true;
+  float _step=0;
+  float _acc=0;
 
   System()=delete;
   System(const System&)=delete;
   System& operator=(const System&)=delete;
 };
 
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// Told when a watched component type comes and goes, see
+// Engine::observe().  Calls are batched up and made in order
+// at the end of Engine::update(), so by then a removed entity
+// is usually dead and an added one may be gone again.
+struct MSVC_DLL Observer {
+
+  virtual void onAdd(Cid, EntityId) {}
+  virtual void onRemove(Cid, EntityId) {}
+
+  virtual ~Observer() {}
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// The by value storage of one plain struct component type,
+// seen without its type, see pod.h
+struct MSVC_DLL Column {
+
+  virtual size_t size() const = 0;
+  // bytes per value
+  virtual size_t stride() const = 0;
+  virtual const std::vector<EntityId>& ids() const = 0;
+  // the values, packed in the same order as ids()
+  virtual const void* data() const = 0;
+
+  virtual bool has(EntityId) const = 0;
+  // the value of this entity, or NULL
+  virtual const void* at(EntityId) const = 0;
+  virtual bool remove(EntityId) = 0;
+  virtual void clear() = 0;
+  // drop the values of every flagged slot, see Registry::sweep()
+  virtual void sweep(const std::vector<uint8_t>& dead) = 0;
+
+  // append n values from raw bytes, none of the
+  // entities may be in the column already
+  virtual void load(const EntityId*, const void*, size_t n) = 0;
+  // same, but all n get the one value
+  virtual void fill(const EntityId*, const void*, size_t n) = 0;
+  // same as load() into an empty column, but the ids are taken
+  // over and the values used in place until first changed, see
+  // SparseSet::borrow()
+  virtual void borrow(std::vector<EntityId>& eids, const void*) = 0;
+
+  virtual ~Column() {}
+};
+
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 struct MSVC_DLL Registry {
 
+  // map backend only, other backends return NULL
   MapEidC* getCache(const Cid&) const;
 
   template<typename T>
   MapEidC* getCache() const;
 
+  // return the component bound to this entity, or NULL
+  template<typename T>
+  T* find(EEntity e) const;
+
+  template<typename T>
+  T* find(EntityId) const;
+
   template<typename T>
   void unbind(EEntity e);
 
+  // a type already bound keeps the old one, observers are
+  // not told again
   template<typename T>
   void bind(T* c, EEntity e);
 
+  template<typename T>
+  void unbind(EntityId);
+
+  template<typename T>
+  void bind(T* c, EntityId);
+
+  // plain struct components, no Component base, stored by value
+  // in one packed array per type whatever the backend, see pod.h.
+  // add() is NULL for a dead entity, get() wants the component to
+  // be there, tryGet() does not
+  template<typename T>
+  T* add(EntityId, const T& v= T());
+
+  template<typename T>
+  T& get(EntityId);
+
+  template<typename T>
+  T* tryGet(EntityId);
+
+  template<typename T>
+  bool has(EntityId) const;
+
+  template<typename T>
+  void erase(EntityId);
+
+  // empty structs are tags, kept as a signature bit and nothing
+  // else, so no allocation.  has() works on them too
+  template<typename T>
+  void tag(EntityId);
+
+  template<typename T>
+  void untag(EntityId);
+
+  // flag T of this entity as changed, see Engine::changed().
+  // Fine from systems running in parallel, the stamps of one
+  // type are taken under that type's lock
+  template<typename T>
+  void touch(EntityId);
+
+  // get() plus touch()
+  template<typename T>
+  T& edit(EntityId);
+
+  // the packed values of T, or NULL
+  template<typename T>
+  SparseSet<T>* column() const;
+
+  Column* column(Cid) const;
+
+  // same as column<T>(), made if missing
+  template<typename T>
+  SparseSet<T>* reifyColumn();
+
+  // storage hooks, override these to provide a different backend
+  virtual void put(Cid, EntityId, EComponent);
+  virtual void remove(Cid, EntityId);
+  virtual Component* lookup(Cid, EntityId) const;
+
+  // collect entities that have all of these components
+  virtual void collect(const std::vector<Cid>&, std::vector<EntityId>&) const;
+
+  // drop every component bound to this entity
+  virtual void purge(EntityId);
+
+  // drop every component of the entities whose slot index is
+  // flagged in dead, one pass over each store
+  virtual void sweep(const std::vector<uint8_t>& dead);
+
+  // every entity bound to this type, with its component
+  virtual void gather(Cid, std::vector<EntityId>&, std::vector<Component*>&) const;
+
+  // drop every component of every entity
+  virtual void clear();
+
   virtual ~Registry();
   Registry() {}
 
+  friend struct Engine;
   private:
 
-  std::map<Cid, MapEidC*> _rego;
+  // store + tell the engine
+  void attach(Cid, EntityId, EComponent);
+  void detach(Cid, EntityId);
+
+  // plain struct storage is the same for all backends
+  void dropPods(EntityId);
+  void sweepPods(const std::vector<uint8_t>&);
+  void clearPods();
+
+  // by cid
+  std::vector<MapEidC*> _rego;
+  std::vector<Column*> _pods;
+  Engine* _engine=NULL;
   Registry(const Registry&) = delete;
   Registry& operator=(const Registry&) = delete;
 };
 
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// Entities having all of some types and none of some others,
+// checked on the signature bits alone, e.g.
+//   g->query(with<Location,Health>().without<Flyable>(), ids);
+struct MSVC_DLL Filter {
+
+  template<typename... T>
+  Filter& with() {
+    (s__conj(all, EntityFeature<T>::id()), ...);
+    return *this;
+  }
+
+  template<typename... T>
+  Filter& without() {
+    (s__conj(none, EntityFeature<T>::id()), ...);
+    return *this;
+  }
+
+  // sorted and without repeats, so equal filters compare equal
+  Filter& normalize();
+
+  bool operator<(const Filter& f) const {
+    return all < f.all || (all == f.all && none < f.none);
+  }
+
+  std::vector<Cid> all;
+  std::vector<Cid> none;
+};
+
+template<typename... T>
+Filter with() { return Filter().with<T...>(); }
+
+template<typename... T>
+Filter without() { return Filter().without<T...>(); }
+
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 struct MSVC_DLL Engine {
 
@@ -154,10 +556,92 @@ struct MSVC_DLL Engine {
   // return all the entities
   EntVec getEnts() const;
 
+  // append the entity objects for these ids
+  void findEnts(const std::vector<EntityId>&, EntVec&) const;
+
+  // append the ids of entities having all of these components,
+  // by scanning the signature bits of the whole entity table
+  void query(const std::vector<Cid>&, std::vector<EntityId>&) const;
+
+  // same scan, for a filter.  No with types means every live
+  // entity not having any of the without ones
+  void query(const Filter&, std::vector<EntityId>&) const;
+  EntVec getEnts(const Filter&) const;
+
+  // true if the entity has all of these components
+  bool hasAll(EntityId, const std::vector<Cid>&) const;
+  bool has(EntityId, Cid) const;
+  bool matches(EntityId, const Filter&) const;
+
+  // the change clock, moves on every update() and every
+  // call to changed()
+  uint64_t tick() const { return _tick; }
+
+  // append the live entities whose cid was bound or touched at
+  // tick since or later, returns the tick to pass in next time.
+  // Start from 0 to get everything which has the component.
+  // Reads under the same lock as touch(), and the clock moves on
+  // inside it, so a touch racing with the read is either in the
+  // result or after the tick returned, never lost
+  uint64_t changed(Cid, uint64_t since, std::vector<EntityId>&);
+
+  template<typename T>
+  uint64_t changed(uint64_t since, std::vector<EntityId>& out) {
+    return changed(EntityFeature<T>::id(), since, out);
+  }
+
+  // a bare entity, no object, no name
+  EntityId spawn();
+
+  // n bare entities made from the prefab, their handles are
+  // appended to out.  Storage grows once for the lot, see prefab.h
+  void spawnBatch(const Prefab&, size_t n, std::vector<EntityId>& out);
+
+  // make child the first child of parent, moving its subtree along
+  // from wherever it was.  False if either is dead or child is
+  // parent or above it.  See hierarchy.h
+  bool adopt(EntityId parent, EntityId child);
+  // cut the entity from its parent, its subtree stays with it
+  void orphan(EntityId);
+  // 0 for roots and entities in no hierarchy
+  EntityId parentOf(EntityId) const;
+  // append the children, or the whole subtree parents first
+  void children(EntityId, std::vector<EntityId>&) const;
+  void descendants(EntityId, std::vector<EntityId>&) const;
+  // every entity in a hierarchy ordered by depth, so parents come
+  // before their children.  Sorted in place when out of order
+  SparseSet<Relation>* hierarchy();
+
+  // true if the handle refers to a live entity
+  bool isAlive(EntityId e) const {
+    auto i= entIndex(e);
+    return i < _gens.size() && _gens[i] == (entGen(e) | GEN_LIVE);
+  }
+
+  // the object for a live entity, made on first use.
+  // Not thread safe, like RefPtr itself
+  EEntity ent(EntityId) const;
+
+  // number of live entities
+  size_t count() const { return _gens.size() - _free.size(); }
+
+  // a cached query, kept up to date as components
+  // are bound and unbound, owned by the engine
+  View* view(const std::vector<Cid>&);
+  View* view(const Filter&);
+
+  template<typename... T>
+  View* view();
+
   // @name name a node, really for debugging only
-  // @take only relevant when entity is pooled
+  // @take reuse the object of an entity which died earlier
+  // instead of making a new one
   EEntity reifyEnt(const stdstr& name, bool take=false);
   EEntity reifyEnt(bool take=false);
+  // or a literal would pick the bool overload
+  EEntity reifyEnt(const char* name, bool take=false) {
+    return reifyEnt(stdstr(name), take);
+  }
 
   // return the config
   const j::json& getCfg() const { return _config; }
@@ -169,9 +653,19 @@ struct MSVC_DLL Engine {
   void purgeSystem(ESystem);
   void purgeSystems();
 
-  // remove nodes
+  // remove nodes, along with all their descendants
+  void purgeEnt(EntityId);
   void purgeEnt(EEntity);
-  void purgeEnts();
+  void purgeEnts() { clearWorld(); }
+
+  // many at once, every store is swept once for the lot
+  // instead of searched once per entity and type
+  void purgeEnts(const std::vector<EntityId>&);
+  void purgeEnts(const Filter&);
+
+  // every entity gone, each store is cleared as a whole and the
+  // entity table in one go.  Stale handles stay stale
+  void clearWorld();
 
   // register+add a system
   ESystem addSystem(ESystem);
@@ -180,11 +674,83 @@ struct MSVC_DLL Engine {
   void ignite();
 
   // each update called will update each system
-  // in order
+  // in order, fixed rate ones as many steps as time covers
   void update(float time);
 
+  // fixed rate systems run at most this many steps per update,
+  // time beyond that is dropped so a slow frame cannot snowball
+  void maxSteps(int n) { _maxSteps= std::max(1,n); }
+  int maxSteps() const { return _maxSteps; }
+
+  // run non-conflicting systems concurrently on this many
+  // threads, 0 goes back to running them one by one
+  void parallel(int workers);
+
+  // the worker pool, NULL unless running in parallel
+  Jobs* jobs() const;
+
+  // the command buffer for the calling thread, use it to
+  // make structural changes while systems are running
+  Commands* cmds();
+
+  // apply all recorded commands, update() does this at the end
+  void flush();
+
+  // call o whenever this type is bound to or dropped from an
+  // entity, purges included.  Not owned, unobserve() before it
+  // goes away
+  void observe(Cid, Observer* o);
+
+  template<typename T>
+  void observe(Observer* o) { observe(EntityFeature<T>::id(), o); }
+
+  void unobserve(Observer*);
+
+  // hand the events so far to the observers, update() does this
+  // after flush().  Changes they make are handed out too
+  void notify();
+
+  // write the entity table, the signatures and every snapshotable
+  // component into a compact binary blob, see snapshot.h
+  void snapshot(std::vector<char>&) const;
+
+  // replace the whole world with a snapshot, false if the blob is
+  // bad.  Entity names and components without a codec are lost,
+  // pending observer events are dropped and none are made.  Do
+  // not call while systems are running
+  bool restore(const char* blob, size_t len);
+  bool restore(const std::vector<char>& blob) {
+    return restore(blob.data(), blob.size());
+  }
+  // skips the parse, the records are still copied into the
+  // engine's own storage, see MappedSnapshot
+  bool restore(const SnapshotImage&);
+  // warm start, takes m over.  By value columns use the mapped
+  // records in place and only copy them in when first changed,
+  // Components are still made one by one.  m is kept until the
+  // next restore() or the engine goes, it is deleted at once if
+  // this fails
+  bool restore(MappedSnapshot* m);
+
+  // write a snapshot to a file, see MappedSnapshot for reading it
+  bool snapshot(const stdstr& file) const;
+
+  // move an entity to another engine: pack its snapshotable
+  // components into the parcel and purge it here, false if it
+  // is dead.  Its descendants are purged too, orphan() them
+  // first to keep them.  The other side calls immigrate(), see
+  // shard.h
+  bool emigrate(EntityId, Parcel&);
+  EntityId immigrate(const Parcel&);
+
+  // timings and counters, NULL unless built with ECS_PROFILE
+  Profiler* profiler() const { return _prof; }
+
   // you can pass in some configurations
   Engine(j::json c) : Engine() { _config=c; }
+  Engine(j::json c, Registry* r) : Engine(r) { _config=c; }
+  // the engine takes ownership of the registry
+  explicit Engine(Registry*);
   Engine();
   virtual ~Engine();
 
@@ -193,12 +759,95 @@ struct MSVC_DLL Engine {
   virtual void initSystems() = 0;
   virtual void initEnts() = 0;
 
+  friend struct Scheduler;
+  friend struct Registry;
   private:
 
+  void unbound(EntityId, Cid);
+  void bound(EntityId, Cid);
+  void touched(EntityId, Cid);
+
+  void erase(EntityId);
+  void kill(uint32_t);
+  void bury(uint32_t);
+
+  // the purge set plus every descendant, all cut from their
+  // parents.  False if no hierarchy is involved
+  bool uproot(const std::vector<EntityId>&, std::vector<EntityId>&);
+  void unlink(SparseSet<Relation>*, EntityId);
+  void recycle();
+
+  // the entity table, dead slots go on the free list with their
+  // generation bumped.  Generations are packed, GEN_LIVE set while
+  // alive, so a handle check is one compare and a snapshot copies
+  // the lot at once.  The objects are made on demand by ent()
+  std::vector<uint32_t> _gens;
+  mutable std::vector<EEntity> _objs;
+  std::vector<uint32_t> _free;
+
+  // component bits of each slot, _sigWords words apiece and
+  // kept apart from the slots so a query scans one flat array.
+  // Starts at 128 bits, widened when a bigger cid shows up.
+  void widen(Cid);
+  std::vector<uint64_t> _sigs;
+  size_t _sigWords=2;
+
+  // when each slot last changed a component type, plus the
+  // changes in tick order so changed() only reads the tail
+  struct ChangeLog {
+    std::vector<uint64_t> at;
+    std::vector<std::pair<uint64_t,uint32_t>> log;
+    // every holder counts as changed from here, see restore()
+    uint64_t all=0;
+    // touch() may come from many systems at once
+    std::mutex lock;
+  };
+  ChangeLog* changes(Cid);
+  void stamp(ChangeLog*, uint32_t);
+  void stamp(ChangeLog*, const EntityId*, size_t n);
+  void trim(ChangeLog*);
+  void forget();
+  // keep is the mapping to borrow from, NULL to copy
+  bool restore(const SnapshotImage&, MappedSnapshot* keep);
+  std::vector<ChangeLog*> _changes;
+  std::atomic<uint64_t> _tick{1};
+
+  // observers by cid, and the events waiting for notify().
+  // Only watched types are queued
+  struct Event {
+    Cid cid;
+    EntityId eid;
+    bool added;
+  };
+  bool watched(Cid cid) const {
+    return cid < (Cid)_observers.size() && !_observers[cid].empty();
+  }
+  void dropped(uint32_t slot, EntityId);
+  std::vector<std::vector<Observer*>> _observers;
+  std::vector<Cid> _watched;
+  std::vector<Event> _pending;
+  std::vector<Event> _sending;
+  bool _notifying=false;
+
+  std::map<Filter,View*> _views;
+  // by cid, with or without
+  std::vector<std::vector<View*>> _viewsByCid;
+  // the ones with no with types, a new entity is in them
+  std::vector<View*> _open;
+
+  std::vector<Commands*> _cmdbufs;
+  std::mutex _cmdLock;
+  llong _serial;
+
   std::vector<ESystem> _systems;
+  Scheduler* _sched=NULL;
+  Profiler* _prof=NULL;
+  // what borrowed by value columns point into
+  MappedSnapshot* _mapped=NULL;
+  int _maxSteps=5;
   j::json _config;
-  MapEidE _ents;
   EntVec _garbo;
+  EntVec _spare;
   Registry* _types;
   bool _updating=false;
 
@@ -210,51 +859,78 @@ struct MSVC_DLL Engine {
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 template<typename T>
 MapEidC* Registry::getCache() const {
-  if (auto i=_rego.find(EntityFeature<T>::id()); i != _rego.end()) {
-    return i->second;
-  } else {
-    return NULL;
-  }
+  return getCache(EntityFeature<T>::id());
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+T* Registry::find(EEntity e) const {
+  return find<T>(e->id());
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+T* Registry::find(EntityId eid) const {
+  return s__cast(T, lookup(EntityFeature<T>::id(), eid));
 }
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 template<typename T>
 void Registry::unbind(EEntity e) {
-  if (auto i= _rego.find(EntityFeature<T>::id()); i != _rego.end()) {
-    auto eid= e->id();
-    auto m= i->second;
-    if (auto it2= m->find(eid); it2 != m->end()) {
-      m->erase(it2);
-    }
-  }
+  detach(EntityFeature<T>::id(), e->id());
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+void Registry::unbind(EntityId e) {
+  detach(EntityFeature<T>::id(), e);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+void Registry::bind(T* c, EntityId e) {
+  attach(EntityFeature<T>::id(), e, c);
 }
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 template<typename T>
 void Registry::bind(T* c, EEntity e) {
-  auto cid= EntityFeature<T>::id();
-  auto eid= e->id();
+  attach(EntityFeature<T>::id(), e->id(), c);
+}
 
-  if (auto i= _rego.find(cid); i != _rego.end()) {} else {
-    _rego.insert(s__pair(Cid,MapEidC*,cid, new MapEidC));
-  }
-  _rego[cid]->insert(s__pair(EntityId,EComponent, eid, c));
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+void Registry::touch(EntityId e) {
+  if (_engine) { _engine->touched(e, EntityFeature<T>::id()); }
 }
 
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+void Registry::tag(EntityId eid) {
+  static_assert(isTag<T>, "tags are empty structs");
+  auto cid= EntityFeature<T>::id();
+  // tagging twice is not a change
+  if (_engine && !_engine->has(eid, cid)) { _engine->bound(eid, cid); }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename T>
+void Registry::untag(EntityId eid) {
+  static_assert(isTag<T>, "tags are empty structs");
+  if (_engine) { _engine->unbound(eid, EntityFeature<T>::id()); }
+}
 
 //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 template<typename T>
 EntVec Engine::getEnts() const {
-  EntVec out;
-  if (auto cc= _types->getCache<T>(); cc) {
-    for (auto i= cc->begin(),e=cc->end();i != e;++i) {
-      auto z= i->first;
-      if (auto it2= _ents.find(z); it2 != _ents.end()) {
-        s__conj(out,it2->second);
-      }
-    }
-  }
-  return out;
+  return getEnts(std::vector<Cid> { EntityFeature<T>::id() });
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename... T>
+View* Engine::view() {
+  return view(std::vector<Cid> { EntityFeature<T>::id()... });
 }
 
 
@@ -0,0 +1,93 @@
+/* Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
+
+#include "view.h"
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+namespace czlab::ecs {
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+View::View(Engine* e, const Filter& f) {
+  _engine=e;
+  _filter=f;
+  refill();
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void View::refill() {
+  std::vector<EntityId> ids;
+  clear();
+  _engine->query(_filter, ids);
+  // query gives each match once, no need to check
+  _pos.reserve(ids.size());
+  for (size_t i=0; i < ids.size(); ++i) { _pos[ids[i]]= i; }
+  _ids.swap(ids);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+bool View::matches(EntityId eid) const {
+  return _engine->matches(eid, _filter);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void View::add(EntityId eid) {
+  if (!has(eid)) {
+    _pos[eid]= _ids.size();
+    s__conj(_ids, eid);
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void View::remove(EntityId eid) {
+  if (auto i= _pos.find(eid); i != _pos.end()) {
+    auto n= i->second;
+    auto t= _ids.back();
+    _pos.erase(i);
+    if (t != eid) {
+      _ids[n]= t;
+      _pos[t]= n;
+    }
+    _ids.pop_back();
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void View::sweep(const std::vector<uint8_t>& dead) {
+  // from the end, so what gets swapped in is already checked
+  for (auto i= _ids.size(); i-- > 0;) {
+    auto k= entIndex(_ids[i]);
+    if (k < dead.size() && dead[k]) { remove(_ids[i]); }
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+void View::clear() {
+  _pos.clear();
+  _ids.clear();
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+EntVec View::ents() const {
+  EntVec out;
+  out.reserve(_ids.size());
+  _engine->findEnts(_ids, out);
+  return out;
+}
+
+
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+//EOF
+
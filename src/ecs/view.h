@@ -0,0 +1,138 @@
+#pragma once
+/* Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright © 2013-2022, Kenneth Leung. All rights reserved. */
+
+//////////////////////////////////////////////////////////////////////////////
+
+#include <unordered_map>
+#include "pod.h"
+#include "sched.h"
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+namespace czlab::ecs {
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+// The set of entities having all of some component types,
+// and maybe none of some others.
+// Membership is updated by the engine on bind, unbind and purgeEnt,
+// so reading the matches costs nothing.
+struct MSVC_DLL View {
+
+  const std::vector<EntityId>& ids() const { return _ids; }
+  // the types required, and the filter with those kept out
+  const std::vector<Cid>& sig() const { return _filter.all; }
+  const Filter& filter() const { return _filter; }
+  size_t size() const { return _ids.size(); }
+
+  bool has(EntityId eid) const { return s__contains(_pos, eid); }
+
+  // the matches as entity objects
+  EntVec ents() const;
+
+  // call f(eid, T&...) for every match, each T must be one
+  // of the types the view requires
+  template<typename... T, typename F>
+  void forEach(F f) const;
+
+  // same as forEach, but chunks of matches are spread over the
+  // engine's workers, runs inline if the engine is not parallel.
+  // Do not bind, unbind or purge from inside f.
+  template<typename... T, typename F>
+  void parallelForEach(F f, size_t chunk=0) const;
+
+  ~View() {}
+
+  friend struct Engine;
+  private:
+
+  View(Engine*, const Filter&);
+
+  // ids per chunk, sized to stay within L1
+  static constexpr size_t CHUNK= 2048;
+
+  template<typename... T, typename F>
+  void eachIn(size_t, size_t, F&) const;
+
+  // a component of either kind
+  template<typename T>
+  static T& ref(Registry* r, EntityId eid) {
+    static_assert(!isTag<T>, "a tag has no value, put it in the view instead");
+    if constexpr (isPod<T>) {
+      return r->template get<T>(eid);
+    } else {
+      return *r->template find<T>(eid);
+    }
+  }
+
+  // true if every T is required, so ref<T>() cannot miss
+  template<typename... T>
+  bool covers() const {
+    auto& all= _filter.all;
+    return ((std::find(all.begin(), all.end(),
+                       EntityFeature<T>::id()) != all.end()) && ...);
+  }
+
+  bool matches(EntityId) const;
+  void remove(EntityId);
+  void add(EntityId);
+  void sweep(const std::vector<uint8_t>&);
+  void clear();
+  void refill();
+
+  std::unordered_map<EntityId,size_t> _pos;
+  std::vector<EntityId> _ids;
+  Filter _filter;
+  Engine* _engine;
+
+  View(const View&) = delete;
+  View& operator=(const View&) = delete;
+};
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename... T, typename F>
+void View::eachIn(size_t begin, size_t end, F& f) const {
+  auto r= _engine->rego();
+  for (auto i=begin; i < end; ++i) {
+    auto eid= _ids[i];
+    f(eid, ref<T>(r, eid)...);
+  }
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename... T, typename F>
+void View::forEach(F f) const {
+  assert((covers<T...>()) && "forEach on a type not in the view");
+  eachIn<T...>(0, _ids.size(), f);
+}
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+template<typename... T, typename F>
+void View::parallelForEach(F f, size_t chunk) const {
+  assert((covers<T...>()) && "forEach on a type not in the view");
+  auto js= _engine->jobs();
+  if (chunk == 0) { chunk= CHUNK; }
+  if (E_NIL(js) || _ids.size() <= chunk) {
+    eachIn<T...>(0, _ids.size(), f);
+  } else {
+    js->parallelFor(_ids.size(), chunk,
+                    [this,&f](size_t b, size_t e) { eachIn<T...>(b, e, f); });
+  }
+}
+
+
+
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+}
+//;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+//EOF
+